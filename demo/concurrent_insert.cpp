@@ -0,0 +1,89 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <time.h>
+#include "../environ.h"
+#include "../util/task_pool.h"
+#include "../trie/impl/base.h"
+#include "../trie/impl/list.cpp"
+#include "../trie/impl/atomic_list.cpp"
+#include "../trie/basis.cpp"
+
+/* One lexicon, filled by 1, 2, 4, .. 32 threads at the same time without
+   a lock; every thread inserts an equal share of the words. Afterwards,
+   every word is looked up. Build with -pthread; link with librt.
+
+	concurrent_insert <words> [max. threads] */
+
+typedef simple_trie<void,AtomicList,char_ptr> Lexicon;
+typedef simple_trie<void,LinkedList,char_ptr> Reference;
+
+using namespace std;
+
+template<class L>
+struct filler {
+    L* lexicon;
+    const vector<string>* words;
+    unsigned threads;
+
+    void operator()(size_t id) const
+    {
+	for(size_t i = id; i < words->size(); i += threads)
+	    lexicon->insert((*words)[i].c_str());
+    }
+};
+
+struct counter {
+    size_t* n;
+    void operator()(const char*, Lexicon&) const { ++*n; }
+};
+
+static double seconds()
+{
+    timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    return t.tv_sec + t.tv_nsec/1e9;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2) {
+	cerr << "usage: " << argv[0] << " words [threads]" << endl;
+	return 1;
+    }
+    unsigned const max_threads = argc > 2? atoi(argv[2]) : 32;
+    fstream src(argv[1]);
+    string s;
+    vector<string> words;
+    while(getline(src, s))
+	words.push_back(s);
+
+    cout << tstamp() << "Inserting " << words.size() << " words, " << task_pool::cores() << " cores" << endl;
+    {
+	Reference* lexicon = new Reference;
+	filler<Reference> fun = { lexicon, &words, 1 };
+	double const start = seconds();
+	fun(0);
+	cout << tstamp() << "LinkedList: " << fixed << setprecision(0) << words.size()/(seconds()-start) << " words/s" << endl;
+    }
+    double base = 0;
+    for(unsigned t = 1; t <= max_threads; t *= 2) {
+	Lexicon* lexicon = new Lexicon;
+	filler<Lexicon> fun = { lexicon, &words, t };
+	double const start = seconds();
+	task_pool::run(t, fun, t);
+	double const time = seconds() - start;
+	if(t == 1) base = time;
+
+	unsigned long missing = 0;
+	for(size_t i=0; i < words.size(); ++i)
+	    missing += !lexicon->search(words[i].c_str());
+	size_t n = 0;
+	counter tally = { &n };
+	for_each_word(*lexicon, tally);
+	cout << tstamp() << setw(3) << t << " threads: " << fixed << setprecision(0) << words.size()/time << " words/s, speedup " << setprecision(2) << base/time << " (" << n << " words, " << missing << " missing)" << endl;
+    }
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <time.h>
+#include "../environ.h"
+#include "../util/task_pool.h"
+#include "../trie/impl/base.h"
+#include "../trie/impl/list.cpp"
+#include "../trie/basis.cpp"
+#include "../trie/parallel.cpp"
+
+/* optimize() against parallel_optimize() on 1, 2, 4, .. threads, each on
+   a freshly built lexicon; the order of the children afterwards (and so
+   the order of the words) must be the same. Build with -pthread; link
+   with librt.
+
+	parallel_optimize <words> [max. threads] */
+
+typedef simple_trie<void,LinkedList,char_ptr> Lexicon;
+
+using namespace std;
+
+struct spell {
+    string* out;
+    void operator()(const char* word, Lexicon&) const { *out += word; *out += '\n'; }
+};
+
+static double seconds()
+{
+    timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    return t.tv_sec + t.tv_nsec/1e9;
+}
+
+static Lexicon* build(const vector<string>& words)
+{
+    Lexicon* lexicon = new Lexicon;
+    for(size_t i=0; i < words.size(); ++i)
+	lexicon->insert(words[i].c_str());
+    return lexicon;
+}
+
+static string order(Lexicon& lexicon)
+{
+    string s;
+    spell fun = { &s };
+    for_each_word(lexicon, fun);
+    return s;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2) {
+	cerr << "usage: " << argv[0] << " words [threads]" << endl;
+	return 1;
+    }
+    unsigned const cores = task_pool::cores();
+    unsigned const max_threads = argc > 2? atoi(argv[2]) : 2*cores;
+    fstream src(argv[1]);
+    string s;
+    vector<string> words;
+    while(getline(src, s))
+	words.push_back(s);
+
+    cout << tstamp() << "Optimizing " << words.size() << " words, " << cores << " cores" << endl;
+    Lexicon* lexicon = build(words);
+    double start = seconds();
+    lexicon->optimize();
+    double const base = seconds() - start;
+    string const expect = order(*lexicon);
+    cout << tstamp() << "optimize(): " << fixed << setprecision(1) << base*1000 << "ms" << endl;
+
+    int status = 0;
+    for(unsigned t = 1; t <= max_threads; t *= 2) {
+	lexicon = build(words);
+	start = seconds();
+	parallel_optimize(*lexicon, t);
+	double const time = seconds() - start;
+	bool const same = order(*lexicon) == expect;
+	if(!same) status = 1;
+	cout << tstamp() << setw(3) << t << " threads: " << fixed << setprecision(1) << time*1000 << "ms, speedup " << setprecision(2) << base/time << " on " << cores << " cores, " << (same? "same order" : "ORDER DIFFERS") << endl;
+    }
+    return status;
+}
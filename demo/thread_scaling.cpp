@@ -0,0 +1,92 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <time.h>
+#include "../environ.h"
+#include "../util/task_pool.h"
+#include "../trie/impl/base.h"
+#include "../trie/impl/list.cpp"
+#include "../trie/impl/vector.cpp"
+#include "../trie/basis.cpp"
+#include "../trie/fuzzy.cpp"
+
+/* One lexicon, searched by 1, 2, 4, .. threads at the same time; every
+   thread gets an equal share of the queries, and only has a const
+   reference to the lexicon. Build with -pthread; link with librt.
+
+	thread_scaling <words> <queries> [max. threads] [distance]
+
+   with distance 0, only exact lookups are done. */
+
+#ifndef FUZZY
+#  define FUZZY 1
+#endif
+
+typedef fuzzy< simple_trie<void,LinkedList,char_ptr> > Lexicon;
+
+using namespace std;
+
+struct worker {
+    const Lexicon* lexicon;
+    const vector<string>* queries;
+    unsigned threads;
+    unsigned distance;
+    vector<unsigned long>* found;
+
+    void operator()(size_t id) const
+    {
+	unsigned long n = 0;
+	for(size_t i = id; i < queries->size(); i += threads) {
+	    const char* const s = (*queries)[i].c_str();
+	    n += distance? lexicon->search_fuzzy(s, distance, 2).size() : !!lexicon->search(s);
+	}
+	(*found)[id] = n;
+    }
+};
+
+static double seconds()
+{
+    timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    return t.tv_sec + t.tv_nsec/1e9;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 3) {
+	cerr << "usage: " << argv[0] << " words queries [threads] [distance]" << endl;
+	return 1;
+    }
+    unsigned const max_threads = argc > 3? atoi(argv[3]) : 2*task_pool::cores();
+    unsigned const distance = argc > 4? atoi(argv[4]) : FUZZY;
+    fstream src(argv[1]);
+    fstream test(argv[2]);
+    string s;
+
+    Lexicon* lexicon = new Lexicon;
+    cout << tstamp() << "Reading in words" << endl;
+    while(getline(src, s))
+	lexicon->insert(s.c_str());
+    lexicon->optimize();
+    vector<string> queries;
+    while(getline(test, s))
+	queries.push_back(s);
+
+    const Lexicon& shared = *lexicon;
+    cout << tstamp() << "Matching " << queries.size() << " queries, " << task_pool::cores() << " cores" << endl;
+    double base = 0;
+    for(unsigned t = 1; t <= max_threads; t *= 2) {
+	vector<unsigned long> found(t);
+	worker fun = { &shared, &queries, t, distance, &found };
+	double const start = seconds();
+	task_pool::run(t, fun, t);
+	double const time = seconds() - start;
+	unsigned long N = 0;
+	for(unsigned i=0; i < t; ++i) N += found[i];
+	if(t == 1) base = time;
+	cout << tstamp() << setw(3) << t << " threads: " << fixed << setprecision(0) << queries.size()/time << " queries/s, speedup " << setprecision(2) << base/time << " (" << N << " results)" << endl;
+    }
+}
@@ -1,3 +1,4 @@
+#pragma once
 #include <cmath>
 #include "../environ.h"
 #include "fnv.h"
@@ -45,6 +46,19 @@ struct hash_table {
 	} 
     }
 
+    bool erase(const char* str)
+    {
+	bucket& b = tab[fnv::hash32(str) & tab.size()-1];
+	for(iterator p = b.begin(); p != b.end(); ++p)
+	    if(strcmp(str, p->first) == 0) {
+		delete[] p->first;
+		b.erase(p);
+		--count;
+		return true;
+	    }
+	return false;
+    }
+
     size_t buckets() const 
     { return tab.size(); }
 
@@ -13,7 +13,9 @@
 #include "trie/impl/tree.cpp"
 #include "trie/impl/vector.cpp"
 #include "trie/impl/dumb.cpp"
+#include "trie/impl/hashed.cpp"
 #include "trie/basis.cpp"
+#include "trie/critbit.cpp"
 #include "trie/turbo.cpp"
 #include "trie/serialize.cpp"
 #include "trie/fuzzy.cpp"
@@ -50,11 +52,13 @@ typedef char key;
 //typedef fuzzy<trie<void,Vector,false,key>, g_nfa<> > Lexicon;
 //typedef fuzzy<trie<void,Vector,false,key>, slide_nfa<4> > Lexicon;
 //typedef simple_trie<void,Array,key> Lexicon;
+//typedef simple_trie<void,Hashed,char> Lexicon;
 //typedef trie<void,LinkedList,true,key> Lexicon;
 //typedef trie<void,LinkedList,true,key> Lexicon;
 //typedef simple_trie<void,Vector,char_store<8> > Lexicon;
 //typedef trie<void,CompactVector,true,char> Lexicon;
 //typedef trie<void,AVLTree,true,char> Lexicon;
+//typedef critbit<> Lexicon;              // exact only, needs FUZZY=0
 //typedef simple_trie<void,Vector,char> Lexicon;
 typedef fuzzy< simple_trie<void,LinkedList,char_ptr> > Lexicon;
 //typedef direct_fuzzy<simple_trie<void,LinkedList,char> > Lexicon;
@@ -108,6 +112,7 @@ int main(int argc, char** argv)
     string s;
     {
     Lexicon* lexicon;
+    bloom_filter filter;
     if(!argv[2] || string(argv[2]) != "+") {
 	lexicon = new Lexicon;
 	cout << tstamp() << "Reading in words" << endl;
@@ -118,9 +123,13 @@ int main(int argc, char** argv)
 	//lexicon->sort();
 	cout << tstamp() << "Optimizing" << endl;
 	lexicon->optimize();
+#if BLOOM
+	cout << tstamp() << "Filtering" << endl;
+	filter = bloom_filter::build(*lexicon);
+#endif
     } else {
 	cout << tstamp() << "Reading" << endl;
-	unserialize::read(src, lexicon);
+	unserialize::read(src, lexicon, &filter);
 	argv++;
 	if(!src) {
 	    cout << tstamp() << "Whoopee!" << endl;
@@ -130,15 +139,34 @@ int main(int argc, char** argv)
     if(argv[3]&&string(argv[3]) == "+") {
         ofstream out(argv[2]);
         cout << tstamp() << "Writing" << endl;
-	serialize::write(out, lexicon);
+	serialize::write(out, lexicon, &filter);
     } else {
-	turbo<Lexicon::trie_type> lexicon_fast(lexicon);
+#if EXACT_INDEX
+	cout << tstamp() << "Indexing" << endl;
+	exact_index<Lexicon::trie_type> index(lexicon);
+	turbo<Lexicon::trie_type> lexicon_fast(lexicon, &filter, &index);
+#else
+	turbo<Lexicon::trie_type> lexicon_fast(lexicon, &filter);
+#endif
         cout << tstamp() << "Matching" << endl;
 	if(argv[2]) {
 	    ifstream test(argv[2]);
 #if !FUZZY
-	    while(getline(test, s))
-		if(lexicon_fast->search(s.c_str())) N++;
+	    unsigned long queries = 0, hits = 0, saved = 0, filtered = 0, indexed = 0;
+	    while(getline(test, s)) {
+		turbo<Lexicon::trie_type>::trace info;
+		if(lexicon_fast->search(s.c_str(), info)) N++;
+		queries++;
+		hits     += info.skipped > 0;
+		saved    += info.skipped;
+		filtered += info.filtered;
+		indexed  += info.indexed;
+	    }
+	    if(lexicon_fast.index)
+		cout << tstamp() << "Exact index: " << memused(*lexicon_fast.index)/1024 << "kb, " << indexed << " of " << queries << " lookups answered" << endl;
+	    cout << tstamp() << "Jump cache: " << lexicon_fast.tab.size()/256 << " tables, " << int(100.0*hits/queries+0.5) << "% hits, " << setprecision(2) << fixed << 1.0*saved/queries << " levels saved on avg." << endl;
+	    if(lexicon_fast.filter)
+		cout << tstamp() << "Bloom filter: " << memused(filter)/1024 << "kb, " << filtered << " of " << queries-N << " misses rejected (" << setprecision(2) << fixed << 100.0*(queries-N-filtered)/std::max(queries-N,1UL) << "% false positives)" << endl;
 #else
 	    while(getline(test, s)) {
 		//cout << N << "\r" << flush;
@@ -0,0 +1,18 @@
+#pragma once
+
+/* Case-insensitive matching for any automaton that has fold_case(): the
+   entries of both cases of a letter in its character table are merged
+   once, so every feed() accepts either case at no extra cost.
+
+   use as e.g. fuzzy<Trie, caseless< fuzzy_nfa<8> > > */
+
+template<class nfa>
+struct caseless : nfa {
+    caseless(const char* text, int dist = nfa::max_distance)
+    : nfa(text, dist)
+    { this->fold_case(); }
+
+    caseless(const char* text, size_t len, int dist)
+    : nfa(text, len, dist)
+    { this->fold_case(); }
+};
@@ -5,6 +5,7 @@
 
 #include <bitset>
 #include <cstring>
+#include <cctype>
 #include <cassert>
 
 #define TRANSPOSITIONS 1
@@ -25,6 +26,23 @@ struct fuzzy_nfa {
 	    pattern[text[i]&0xFF] |= one << i;
     }
 
+    fuzzy_nfa(const char* text, size_t len, int dist) 
+    : pattern(),  width(len), height(dist)
+    {
+	std::bitset<N> one = 1;
+	for(int i=0; i < width; ++i) 
+	    pattern[text[i]&0xFF] |= one << i;
+    }
+
+    // let a letter match in either case (see caseless_nfa.h)
+    void fold_case()
+    {
+	for(int c=0; c < 256; ++c) {
+	    int const u = std::toupper(c);
+	    if(u != c) pattern[c] = pattern[u] |= pattern[c];
+	}
+    }
+
     struct state {
 	std::bitset<N> reg[max_distance+1];
 #if TRANSPOSITIONS
@@ -16,6 +16,7 @@
 
 #include <bitset>
 #include <cstring>
+#include <cctype>
 #include <cassert>
 
 #define ZEROTRANS 1
@@ -70,6 +71,15 @@ struct limex_nfa {
 	}
     }
 
+    // let a letter match in either case (see caseless_nfa.h)
+    void fold_case()
+    {
+	for(int c=0; c < 256; ++c) {
+	    int const u = std::toupper(c);
+	    if(u != c) pattern[c] = pattern[u] |= pattern[c];
+	}
+    }
+
     struct state {
 	std::bitset<N> reg[max_editdistance+1];
 
@@ -17,6 +17,7 @@
  */
 
 #include <cstring>
+#include <cctype>
 #include <cassert>
 
 template<class bits = unsigned long long>
@@ -32,6 +33,22 @@ struct myers_nfa {
 	    Peq[text[i]&0xFF] |= bits(1) << i;
     }
 
+    myers_nfa(const char* text, size_t len, unsigned dist)
+    : Peq(),  width(len), height(dist)
+    {
+	for(int i=0; i < width; ++i) 
+	    Peq[text[i]&0xFF] |= bits(1) << i;
+    }
+
+    // let a letter match in either case (see caseless_nfa.h)
+    void fold_case()
+    {
+	for(int c=0; c < 256; ++c) {
+	    int const u = std::toupper(c);
+	    if(u != c) Peq[c] = Peq[u] |= Peq[c];
+	}
+    }
+
     struct state {
 	bits Pv,Mv;
 	unsigned short Score;
@@ -6,6 +6,7 @@
 
 #include <bitset>
 #include <cstring>
+#include <cctype>
 #include <cassert>
 #include <math.h>
 
@@ -29,6 +30,23 @@ struct slide_nfa {
 	    pattern[text[i]&0xFF] |= one << i;
     }
 
+    slide_nfa(const char* text, size_t len, int dist) 
+    : width(len), height(dist), pattern()
+    {
+	std::bitset<K> one = 1;
+	for(int i=0; i < width; ++i) 
+	    pattern[text[i]&0xFF] |= one << i;
+    }
+
+    // let a letter match in either case (see caseless_nfa.h)
+    void fold_case()
+    {
+	for(int c=0; c < 256; ++c) {
+	    int const u = std::toupper(c);
+	    if(u != c) pattern[c] = pattern[u] |= pattern[c];
+	}
+    }
+
     struct state {
 	Bitstate reg[max_distance+1];
 	short shift;
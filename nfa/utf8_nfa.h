@@ -0,0 +1,122 @@
+#pragma once
+
+/* Edit distance in characters instead of bytes, for UTF-8 text, around
+   any automaton with a (text, len, dist) constructor:
+
+	fuzzy<Trie, utf8_nfa< fuzzy_nfa<8> > >
+
+   the pattern is rewritten as one byte per character: ASCII stays as it
+   is, and every other character gets a class byte of its own (the first
+   127 distinct ones; a pattern is never that long). Bytes are fed one at
+   a time as usual; the bytes of a multibyte character are collected in
+   the state, and the automaton only sees its class once it is complete,
+   so "é" for "e" costs one edit. ASCII bytes go straight through. A
+   character that is cut short counts as one, as in utf8::decode. */
+
+#include <string>
+#include <cstring>
+#include <stdint.h>
+#include "../util/utf8.h"
+
+struct utf8_classes {
+    uint32_t cp[127];        // the character of class 0x80+i
+    unsigned char classes;
+    std::string text;        // the pattern, one byte per character
+
+    utf8_classes(const char* str, size_t len)
+    : classes(), text(str, utf8::ascii_prefix(str, len))
+    {
+	for(size_t i = text.size(); i < len; ) {
+	    if(!(str[i] & 0x80)) {
+		text += str[i++];
+		continue;
+	    }
+	    uint32_t const c = utf8::decode(str, i, len);
+	    char k = lookup(c);
+	    if(k == char(0xFF) && classes < 127) {
+		cp[classes] = c;
+		k = char(0x80 + classes++);
+	    }
+	    text += k;
+	}
+    }
+
+    // the class of a character that is not ASCII; 0xFF if it is not in the pattern
+    char lookup(uint32_t c) const
+    {
+	for(unsigned i=0; i < classes; ++i)
+	    if(cp[i] == c) return char(0x80 + i);
+	return char(0xFF);
+    }
+};
+
+template<class nfa>
+struct utf8_nfa : utf8_classes, nfa {
+    utf8_nfa(const char* str, int dist = nfa::max_distance)
+    : utf8_classes(str, std::strlen(str)), nfa(text.data(), text.size(), dist)
+    { }
+
+    utf8_nfa(const char* str, size_t len, int dist)
+    : utf8_classes(str, len), nfa(text.data(), text.size(), dist)
+    { }
+
+    struct state : nfa::state {
+	uint32_t cp;             // the character being read
+	unsigned short need;     // the number of its bytes still to come
+	unsigned short dist;     // what the last complete character returned
+
+	unsigned feed(const utf8_nfa& fsm, char c)
+	{ return fsm.feed(*this, c, *this); }
+    };
+
+    state start()
+    {
+	state s;
+	static_cast<typename nfa::state&>(s) = nfa::start();
+	s.cp = s.need = s.dist = 0;
+	return s;
+    }
+
+    unsigned feed(const state& fsm, char c, state& fsmnew) const
+    {
+	if(fsm.need && !utf8::continuation(c)) {
+	    // the character being read was cut short: feed it, then start afresh on c
+	    state done = fsm;
+	    done.need = 0;
+	    done.dist = nfa::feed(fsm, lookup(fsm.cp), done);
+	    return feed(done, c, fsmnew);
+	}
+	if(!(c & 0x80) && !fsm.need) {
+	    fsmnew.need = 0;
+	    return fsmnew.dist = nfa::feed(fsm, c, fsmnew);
+	}
+
+	uint32_t cp;
+	unsigned need;
+	if(fsm.need) {
+	    cp = fsm.cp << 6 | c & 0x3F;
+	    need = fsm.need-1;
+	} else {
+	    need = utf8::sequence_length(c)-1;
+	    cp = c & (need? 0x3F >> need : 0xFF);
+	}
+	if(need) {
+	    if(&fsmnew != &fsm) fsmnew = fsm;
+	    fsmnew.cp = cp;
+	    fsmnew.need = need;
+	    return fsm.dist;
+	}
+	fsmnew.need = 0;
+	return fsmnew.dist = nfa::feed(fsm, lookup(cp), fsmnew);
+    }
+
+    // a word can also end in the middle of a character
+    unsigned accepts_dist(const state& fsm) const
+    {
+	if(!fsm.need)
+	    return nfa::accepts_dist(fsm);
+	state done = fsm;
+	nfa::feed(fsm, lookup(fsm.cp), done);
+	return nfa::accepts_dist(done);
+    }
+};
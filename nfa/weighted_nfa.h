@@ -65,6 +65,11 @@ struct weighted_nfa {
     {
     }
 
+    weighted_nfa(const char* text, size_t len, int dist, const cost_table& costs = cost_table()) 
+    : D(costs), pattern(text),  width(len), height(dist)
+    {
+    }
+
     struct state {
 	unsigned char col[N];
 	unsigned short shift, stop;
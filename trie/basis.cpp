@@ -2,10 +2,16 @@
 
 #include <cstddef>
 #include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <utility>
 #include "../util/containers.h"
 #include "../environ.h"
 #include "impl/base.h"
 #include "impl/vector.cpp"
+#include "impl/hashed.cpp"
+#include "impl/rcu.cpp"
 
 // experimentally, we find 3 to be best.
 #define DEMOTE 3
@@ -21,21 +27,92 @@
 /* a boxed value */
 
 template<class T> struct value {
+    typedef T info_type;
     typedef T& reference;
     T info;
     explicit value(const T& val = T()) : info(val) { }
-    void set(const value& val = T()) { info = val.info; }
+    void set(const value& val = value()) { info = val.info; }
 
     const T* operator->() const { return &info; }
     T* operator->() { return &info; }
 };
 
 template<> struct value<void> { 
+    typedef void info_type;
     typedef void reference;
     value(bool = 0) { }
     void set(value = 0) { }
 };
 
+/* recycled nodes: erase() hands them back here, and new nodes are taken
+   from here first. nodes of an unserialized trie are one block (see
+   serialize.cpp), so they are never returned to the heap. every thread
+   has a free list of its own */
+
+template<class T>
+struct node_pool {
+    static void* get(size_t n)
+    {
+	void*& head = free_list();
+	if(n != sizeof(T) || !head) return ::operator new(n);
+	void* const p = head;
+	head = *static_cast<void**>(p);
+	return p;
+    }
+
+    static void put(void* p, size_t n)
+    {
+	if(n != sizeof(T)) return ::operator delete(p);
+	void*& head = free_list();
+	*static_cast<void**>(p) = head;
+	head = p;
+    }
+
+private:
+    static void*& free_list() { static __thread void* head = 0; return head; }
+};
+
+template<class T, class K>
+struct only_child {
+    std::pair<K,T*>* res;
+    void operator()(K key, T& node) const { *res = std::make_pair(key, &node); }
+};
+
+// replace the edge to child and the one below it by a single edge, if the key type allows
+template<class T>
+void join_edge(T&, char, T*, char)
+{ }
+
+template<class T, class K>
+void join_edge(T& parent, char ch, T* child, K)
+{
+    std::pair<K,T*> next;
+    only_child<T,K> fun = { &next };
+    child->explore(fun, false);
+    std::pair<K,T*> edge = parent.detach_node(ch);
+    if(key_traits<K>::join(edge.first, next.first)) {
+	parent.attach_node(edge.first, next.second);
+	delete child;
+    } else
+	parent.attach_node(edge.first, child);
+}
+
+/* after erasing below parent: remove its child at ch if nothing is left
+   in it, or else merge it with its only child, so the edges are as long
+   as they would be in a freshly built trie */
+
+template<class T>
+void prune(T& parent, char ch, T* child)
+{
+    if(child->search_key)
+	return;
+    if(child->empty()) {
+	free_key(parent.detach_node(ch).first);
+	delete child;
+    } else if(child->arity() == 1)
+	join_edge(parent, ch, child, typename T::key_type());
+}
+
 /* the trie itself */
 
 struct trie_storage {
@@ -54,21 +131,29 @@ struct trie : trie_storage, Link<trie<T,Link,Reduced,Key>, Key>, value<T> {
     trie() 
     : trie_storage() { }
 
-    trie(const char* key, size_t ofs=0)
+    template<class S>
+    trie(S key, size_t ofs=0)
     : trie_storage(own_key(key,ofs)) { }
 
-    static trie& create(trie*& node, const char* key, size_t ofs=0)
+    template<class S>
+    static trie& create(trie*& node, S key, size_t ofs=0)
     {
 	return *(node = new trie(key,ofs));
     }
+
+    static void* operator new(size_t n)           { return node_pool<trie>::get(n); }
+    static void operator delete(void* p, size_t n) { node_pool<trie>::put(p, n); }
       
-    static const char* own_key(const char* key, size_t ofs=0) 
+    template<class S>
+    static const char* own_key(S key, size_t ofs=0) 
     {
-	if(Reduced) key += ofs;
-	return *key? std::strcpy(new char[std::strlen(key)+1], key) : "";
+	if(!Reduced) ofs = 0;
+	size_t const len = key_length(key, ofs);
+	return len? key_copy(key, ofs, len) : "";
     }
 
-    bool match_tail(const char* str, size_t i=0) const
+    template<class S>
+    bool match_tail(S str, size_t i=0) const
     {
 	const size_t ofs = Reduced? i : 0;
         do {
@@ -77,7 +162,8 @@ struct trie : trie_storage, Link<trie<T,Link,Reduced,Key>, Key>, value<T> {
         return true;
     }
 
-    const trie* search(const char* str, size_t ofs=0)
+    template<class S>
+    const trie* search(S str, size_t ofs=0)
     {
         trie* cur_trie = this;
         do if(cur_trie->search_key && cur_trie->match_tail(str,ofs))
@@ -88,12 +174,26 @@ struct trie : trie_storage, Link<trie<T,Link,Reduced,Key>, Key>, value<T> {
 	return 0;
     }
 
-    bool shorter_than_tail(const char* str, size_t i=0) const
+    // never writes, so a trie can be shared by threads
+    template<class S>
+    const trie* search(S str, size_t ofs=0) const
+    {
+        const trie* cur_trie = this;
+        do if(cur_trie->search_key && cur_trie->match_tail(str,ofs))
+            return cur_trie;
+        else
+	    cur_trie = str[ofs]? find_child(*cur_trie, str, ofs) : 0;
+        while(cur_trie);
+	return 0;
+    }
+
+    template<class S>
+    bool shorter_than_tail(S str, size_t i=0) const
     {
 	const size_t ofs = Reduced? i : 0;
         while(str[i]) 
             if(!search_key[i++-ofs]) return false;
-        return true;
+        return search_key[i-ofs];
     }
 
     bool probe(char ch) 
@@ -103,12 +203,19 @@ struct trie : trie_storage, Link<trie<T,Link,Reduced,Key>, Key>, value<T> {
 	return link::find_node(str,_);
     }
 
-    trie& insert(const char* str, const size_t ofs = 0)
+    template<class S>
+    trie& insert(S str, const size_t ofs = 0)
     {
         if(search_key && match_tail(str,ofs))
 	    return *this;
 	else {
 	    const char has_tail = search_key? search_key[Reduced?0:ofs] : 0;
+	    #if DEMOTE > 2
+	    // a split edge leaves nodes without a key above existing words
+	    if(str[ofs] && (!search_key || has_tail && shorter_than_tail(str,ofs)))
+		if(const trie* found = search(str,ofs))
+		    return const_cast<trie&>(*found);
+	    #endif
 	    #if DEMOTE == 4
 	    bool conflict;
             if(has_tail && (!str[ofs] || 
@@ -120,9 +227,20 @@ struct trie : trie_storage, Link<trie<T,Link,Reduced,Key>, Key>, value<T> {
 	    #else
             if(has_tail) {
 	    #endif
-		link::select_node(search_key, Reduced?0:ofs).set(*this);
-		if(*search_key) delete[] search_key;
+		/* the word moves down with its value. the node below made a copy
+		   of its key string; if the old one is part of an unserialized
+		   block, the node gets that instead, and the copy is freed */
+		trie& down = link::select_node(search_key, Reduced?0:ofs);
+		down.set(*this);
+		if(owned_text(search_key))
+		    delete[] search_key;
+		else {
+		    const char* const copy = down.search_key;
+		    down.search_key = search_key + (std::strlen(search_key) - std::strlen(copy));
+		    free_text(copy);
+		}
 		search_key = 0;
+		this->set();
             }
 	    #if DEMOTE > 2
 	    if(!search_key) {
@@ -138,8 +256,72 @@ struct trie : trie_storage, Link<trie<T,Link,Reduced,Key>, Key>, value<T> {
         }
     }
 
+    /* remove a word; false if it was not there. the shortest word below
+       takes its place, and nodes left empty are removed. key strings are
+       freed, unless they are part of an unserialized block */
+    template<class S>
+    bool erase(S str)
+    {
+	std::vector<edge> path;
+	trie* cur = this;
+	size_t ofs = 0;
+	while(!(cur->search_key && cur->match_tail(str,ofs))) {
+	    edge e = { cur, str[ofs], 0 };
+	    if(!e.ch || !(cur = cur->find_node(str,ofs,false)))
+		return false;
+	    e.child = cur;
+	    path.push_back(e);
+	}
+	free_text(cur->search_key);
+	cur->search_key = 0;
+	cur->set();
+	for(;;) {
+	    trie* next = 0;
+	    std::string label;
+	    size_t len = 0;
+	    shortest fun = { &next, &label, &len };
+	    cur->explore(fun, false);
+	    if(!next) break;
+	    const char* const moved = next->search_key;
+	    cur->search_key = Reduced? own_key((label+moved).c_str()) : moved;
+	    cur->set(*next);
+	    next->search_key = 0;
+	    if(Reduced) free_text(moved);
+	    next->set();
+	    edge const e = { cur, label[0], next };
+	    path.push_back(e);
+	    cur = next;
+	}
+	for( ; !path.empty(); path.pop_back())
+	    prune(*path.back().parent, path.back().ch, path.back().child);
+	return true;
+    }
+
     typename value<T>::reference operator[](const char* str) 
     { return insert(str).info; }
+
+private:
+    struct edge {
+	trie* parent;
+	char ch;
+	trie* child;
+    };
+
+    // the child with the shortest word
+    struct shortest {
+	trie** node;
+	std::string* label;
+	size_t* len;
+	void operator()(Key key, trie& child) const
+	{
+	    if(!child.search_key) return;
+	    std::string lab;
+	    key_traits<Key>::append(lab, key);
+	    size_t const n = std::strlen(child.search_key) + (Reduced? lab.size() : 0);
+	    if(!*node || n < *len)
+		*node = &child, *label = lab, *len = n;
+	}
+    };
 };
 
 
@@ -156,7 +338,8 @@ struct simple_trie : Link<simple_trie<T,Link,Key>, Key>, value<T> {
 
     bool search_key;
 
-    static simple_trie& create(simple_trie*& node, const char* key, size_t ofs=0)
+    template<class S>
+    static simple_trie& create(simple_trie*& node, S key, size_t ofs=0)
     {
 	node = new simple_trie(key[ofs] == '\0');
 	if(key[ofs]) 
@@ -164,13 +347,18 @@ struct simple_trie : Link<simple_trie<T,Link,Key>, Key>, value<T> {
 	else
 	    return *node;
     }
+
+    static void* operator new(size_t n)           { return node_pool<simple_trie>::get(n); }
+    static void operator delete(void* p, size_t n) { node_pool<simple_trie>::put(p, n); }
       
-    bool match_tail(const char* str, size_t i=0) const
+    template<class S>
+    bool match_tail(S str, size_t i=0) const
     {
 	return str[i] == '\0';
     }
 
-    const simple_trie* search(const char* str, size_t ofs=0)
+    template<class S>
+    const simple_trie* search(S str, size_t ofs=0)
     {
         simple_trie* cur_trie = this;
         do if(cur_trie->search_key && str[ofs] == '\0')
@@ -181,19 +369,90 @@ struct simple_trie : Link<simple_trie<T,Link,Key>, Key>, value<T> {
 	return 0;
     }
 
-    simple_trie& insert(const char* str, const size_t ofs=0)
+    // never writes, so a trie can be shared by threads; pairs with insert()
+    template<class S>
+    const simple_trie* search(S str, size_t ofs=0) const
+    {
+        const simple_trie* cur_trie = this;
+        do if(str[ofs] == '\0' && __atomic_load_n(&cur_trie->search_key, __ATOMIC_ACQUIRE))
+            return cur_trie;
+        else
+	    cur_trie = str[ofs]? find_child(*cur_trie, str, ofs) : 0;
+        while(cur_trie);
+	return 0;
+    }
+
+    template<class S>
+    simple_trie& insert(S str, const size_t ofs=0)
     {
 	if(str[ofs] == '\0') {
-	    search_key = true;
+	    // a word on an existing node, which readers may be in (see rcu.cpp)
+	    __atomic_store_n(&search_key, true, __ATOMIC_RELEASE);
 	    return *this;
 	} else 
 	    return link::select_node(str, ofs);
     }
 
+    // remove a word; false if it was not there
+    template<class S>
+    bool erase(S str, size_t ofs=0)
+    {
+	if(str[ofs] == '\0') {
+	    if(!search_key) return false;
+	    search_key = false;
+	    this->set();
+	    return true;
+	}
+	char const ch = str[ofs];
+	simple_trie* const sub = link::find_node(str,ofs,false);
+	if(!sub || !sub->erase(str,ofs))
+	    return false;
+	prune(*this, ch, sub);
+	return true;
+    }
+
     typename value<T>::reference operator[](const char* str) 
     { return insert(str).info; }
 };
 
+/* enumerate all words in a trie; fun(word, node) */
+
+template<class T, class F>
+struct word_walker {
+    typedef typename T::key_type key_type;
+    F& fun;
+    std::string& path;
+
+    void operator()(key_type key, T& node) const
+    {
+	size_t const len = path.size();
+	key_traits<key_type>::append(path, key);
+	visit(node);
+	path.resize(len);
+    }
+
+    void visit(T& node) const
+    {
+	if(node.search_key) {
+	    std::string word(T::full_key? std::string() : path);
+	    tail(word, node.search_key);
+	    fun(word.c_str(), node);
+	}
+	node.template explore<const word_walker&>(*this, true);
+    }
+
+    static void tail(std::string&, bool) { }
+    static void tail(std::string& word, const char* key) { word += key; }
+};
+
+template<class T, class F>
+void for_each_word(T& lexicon, F fun)
+{
+    std::string path;
+    word_walker<typename T::trie_type,F> walker = { fun, path };
+    walker.visit(lexicon);
+}
+
 
 template<class T> 
 size_t memused(T const& t, size_t allocated(size_t) = allocated)
@@ -262,6 +521,28 @@ size_t memused(const CompactVector<T,K>& t, size_t allocated(size_t) = allocated
     return allocated(capa+2+capa*sizeof(T*));
 }
 
+template<class T, class K>
+size_t memused(const StrideVector<T,K>& t, size_t allocated(size_t) = allocated)
+{
+    return allocated(t.capacity()*sizeof(std::pair<K,T*>));
+}
+
+// a share of the table, in proportion to the edges
+template<class T>
+size_t memused(const Hashed<T,char>& t, size_t allocated(size_t) = allocated)
+{
+    typedef Hashed<T,char> link;
+    size_t const size = allocated(link::table.slot.size()*sizeof(typename link::entry));
+    return link::table.used? size * t.arity() / link::table.used : 0;
+}
+
+template<class T, class K>
+size_t memused(const RCUVector<T,K>& t, size_t allocated(size_t) = allocated)
+{
+    typedef RCUVector<T,K> link;
+    return t.tails? allocated(sizeof(typename link::block) + t.arity()*sizeof(typename link::value_type)) : 0;
+}
+
 template<class T, class K>
 size_t memused(const IndirectVector<T,K>& t, size_t allocated(size_t) = allocated)
 {
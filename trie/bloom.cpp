@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+#include "../hash/fnv.h"
+#include "basis.cpp"
+
+ /* A Bloom filter over all words in a lexicon, to reject most absent
+    words before walking the trie. The k probes are derived from a single
+    64-bit FNV hash (h1 + i*h2, Kirsch & Mitzenmacher). */
+
+#ifndef BLOOM
+#define BLOOM 10   // bits per word; 0 disables the filter
+#endif
+
+struct bloom_filter {
+    std::vector<uint64_t> bits;
+    unsigned k;
+
+    bloom_filter() : bits(), k() { }
+
+    bloom_filter(size_t words, unsigned bits_per_word = BLOOM)
+    : bits(words*bits_per_word/64+1), k(bits_per_word*69/100 + 1)
+    { }
+
+    template<class T>
+    static bloom_filter build(T& lexicon, unsigned bits_per_word = BLOOM)
+    {
+	size_t n = 0;
+	for_each_word(lexicon, counter(n));
+	bloom_filter filter(n, bits_per_word);
+	for_each_word(lexicon, inserter(filter));
+	return filter;
+    }
+
+    bool empty() const
+    {
+	return !k;
+    }
+
+    template<class S>
+    void insert(S str)
+    {
+	uint64_t const h = hash(str);
+	uint32_t const h1 = h, h2 = h >> 32 | 1;
+	size_t const m = bits.size()*64;
+	for(unsigned i=0; i < k; ++i) {
+	    size_t const pos = (h1 + i*h2) % m;
+	    bits[pos/64] |= uint64_t(1) << pos%64;
+	}
+    }
+
+    template<class S>
+    bool contains(S str) const
+    {
+	uint64_t const h = hash(str);
+	uint32_t const h1 = h, h2 = h >> 32 | 1;
+	size_t const m = bits.size()*64;
+	for(unsigned i=0; i < k; ++i) {
+	    size_t const pos = (h1 + i*h2) % m;
+	    if(!(bits[pos/64] >> pos%64 & 1)) return false;
+	}
+	return true;
+    }
+
+private:
+    template<class S>
+    static uint64_t hash(S str)
+    {
+	uint64_t h = 14695981039346656037ULL;
+	for(size_t i=0; char c = str[i]; ++i)
+	    h = fnv::hash64(h, c);
+	return h;
+    }
+
+    struct counter {
+	size_t& n;
+	explicit counter(size_t& n) : n(n) { }
+	template<class T> void operator()(const char*, T&) { ++n; }
+    };
+
+    struct inserter {
+	bloom_filter& filter;
+	explicit inserter(bloom_filter& filter) : filter(filter) { }
+	template<class T> void operator()(const char* word, T&) { filter.insert(word); }
+    };
+};
+
+size_t memused(const bloom_filter& filter, size_t allocated(size_t) = allocated)
+{
+    return allocated(filter.bits.capacity()*sizeof(uint64_t));
+}
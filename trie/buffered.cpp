@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <sstream>
+#include <functional>
+#include <pthread.h>
+
+#include "impl/base.h"
+#include "basis.cpp"
+#include "serialize.cpp"
+
+/* a lexicon that keeps taking new words, while most of them sit in a
+   frozen base that is as fast to search as an unserialized lexicon
+
+   use as buffered< fuzzy< simple_trie<void,Link,Key> > >; new words go
+   into a small trie, the delta. once that holds threshold words, a
+   thread of its own folds it into a new base: the words are inserted
+   into a copy of the base, which is serialized, read back in as a single
+   block, and optimized. meanwhile the full delta is still searched, and
+   new words go into a fresh one; the new base is taken up by the first
+   insert() or flush() after the merge is done.
+
+   a word is only ever in one of the levels, and searches look at all of
+   them. a fuzzy search runs one automaton through them in turn, so in
+   the best-only modes, a match in the delta narrows the search in the
+   base. the lexicon is for one thread; link with -pthread. words cannot
+   be erased, and there are no values, as serialize.cpp does not write
+   them. */
+
+template<class T>
+struct buffered {
+    typedef typename T::trie_type node_type;
+    typedef typename T::result result;
+    typedef typename T::nfa_type nfa;
+    typedef typename T::nfastate nfastate;
+
+    explicit buffered(size_t threshold = 1<<14)
+    : threshold(threshold), pending(), delta(new T), frozen(), base(), base_text(), busy()
+    { }
+
+    ~buffered()
+    {
+	if(busy) finish();
+	dispose(delta);
+	delete[] base;
+	delete[] base_text;
+    }
+
+    // false if the word was there already
+    template<class S>
+    bool insert(S str)
+    {
+	if(busy && __atomic_load_n(&done, __ATOMIC_ACQUIRE)) finish();
+	if(search(str)) return false;
+	delta->insert(str);
+	if(++pending >= threshold && !busy) start();
+	return true;
+    }
+
+    // fold all words into the base now
+    void flush()
+    {
+	if(busy) finish();
+	if(pending) start();
+	if(busy) finish();
+    }
+
+    template<class S>
+    const node_type* search(S str) const
+    {
+	const T* const level[] = { delta, frozen, base };
+	for(int i=0; i < 3; ++i)
+	    if(level[i])
+		if(const node_type* p = level[i]->search(str)) return p;
+	return 0;
+    }
+
+    const node_type* search(const char* str, unsigned limit) const
+    {
+	std::vector<result> res;
+	search_fuzzy(res, str, limit, 2);
+	return res.empty()? 0 : res[0].first;
+    }
+
+    std::vector<result> search_fuzzy(const char* str, unsigned limit=nfa::max_distance, char mode=true) const
+    {
+	std::vector<result> res;
+	search_fuzzy(res, str, limit, mode);
+	return res;
+    }
+
+    // the automaton lowers its bound as it finds better matches, in every level after that as well
+    void search_fuzzy(std::vector<result>& res, const char* str, unsigned limit=nfa::max_distance, char mode=true) const
+    {
+	nfa fsm(str, limit);
+	nfastate init = fsm.start();
+	const T* const level[] = { delta, frozen, base };
+	for(int i=0; i < 3; ++i)
+	    if(level[i])
+		level[i]->search_nfa(res, fsm, init, mode);
+    }
+
+    size_t const threshold;
+
+private:
+    size_t pending;     // words in the delta
+    T* delta;
+    T* frozen;          // the delta that is being merged
+    T* base;            // a block, or 0
+    char* base_text;
+
+    bool busy, done;
+    pthread_t worker;
+    T* work;            // the copy of the base the merge inserts into
+    char* work_text;
+    size_t work_size;
+    T* next;
+    char* next_text;
+
+    void start()
+    {
+	frozen = delta;
+	delta = new T;
+	pending = 0;
+	done = false;
+	if(pthread_create(&worker, 0, merge, this) == 0)
+	    busy = true;
+	else
+	    merge(this), adopt();
+    }
+
+    void finish()
+    {
+	pthread_join(worker, 0);
+	busy = false;
+	adopt();
+    }
+
+    static void* merge(void* arg)
+    {
+	buffered& self = *static_cast<buffered*>(arg);
+	self.work_text = 0;
+	self.work_size = 0;
+	if(self.base) {
+	    self.work = freeze(self.base, self.work_text);
+	    counter fun = { &self.work_size };
+	    fun(char(), *self.work);
+	} else
+	    self.work = new T;
+	adder fun = { self.work };
+	for_each_word(*self.frozen, fun);
+	// after reading, as a LinkedList comes back in reverse order
+	self.next = freeze(self.work, self.next_text);
+	self.next->optimize();
+	__atomic_store_n(&self.done, true, __ATOMIC_RELEASE);
+	return 0;
+    }
+
+    void adopt()
+    {
+	// the nodes that were added to the copy of the base are not in its block
+	dispose(work, work, work+work_size);
+	if(work_text) {
+	    delete[] work;
+	    delete[] work_text;
+	}
+	delete[] base;
+	delete[] base_text;
+	base = next;
+	base_text = next_text;
+	dispose(frozen);
+	frozen = 0;
+    }
+
+    // a copy of lex in one block
+    static T* freeze(T* lex, char*& text)
+    {
+	std::stringstream image;
+	serialize::write(image, lex);
+	T* block = 0;
+	unserialize::read(image, block, 0, &text);
+	return block;
+    }
+
+    struct adder {
+	T* into;
+	void operator()(const char* word, node_type&) const { into->insert(word); }
+    };
+
+    struct counter {
+	size_t* n;
+	template<class K>
+	void operator()(K, node_type& node) const { ++*n; node.explore(*this, false); }
+    };
+
+    struct collect {
+	std::vector<node_type*>* list;
+	template<class K>
+	void operator()(K, node_type& child) const { list->push_back(&child); }
+    };
+
+    // hand the nodes of a trie back to node_pool, except those in [lo,hi)
+    template<class N>
+    static void dispose(N* node, const void* lo=0, const void* hi=0)
+    {
+	std::vector<node_type*> children;
+	collect fun = { &children };
+	node->explore(fun, false);
+	for(size_t i=0; i < children.size(); ++i)
+	    dispose(children[i], lo, hi);
+	std::less<const void*> before;
+	if(before(node, lo) || !before(node, hi))
+	    delete node;
+    }
+
+    buffered(const buffered&);
+    void operator=(const buffered&);
+};
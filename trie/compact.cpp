@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <utility>
+#include "basis.cpp"
+
+ /* Path compression after the fact: build with a char trie, where an
+    insert is cheap, and turn it into the patricia layout for querying:
+
+	simple_trie<void,Vector,char_ptr>* p =
+	    patricia< simple_trie<void,Vector,char_ptr> >(lexicon);
+
+    Every chain of nodes that have one child and hold no word becomes a
+    single edge of the destination key type; with char_store<N>, a chain
+    longer than N is cut into edges of N characters. Values are copied.
+    The source is left as it is, and any link type may be used on either
+    side; call optimize() on the result as usual.
+
+    This works from simple_trie<> to simple_trie<>; otherwise the words are
+    simply inserted one by one, as a trie<> keeps them in inner nodes. */
+
+namespace compact_impl {
+    template<class D, class S>
+    struct copier {
+	typedef typename D::key_type dst_key;
+	typedef typename S::key_type src_key;
+
+	D* into;
+
+	struct only {
+	    std::pair<src_key,S*>* res;
+	    void operator()(src_key key, S& node) const { *res = std::make_pair(key, &node); }
+	};
+
+	void operator()(src_key key, S& node) const
+	{
+	    std::string label;
+	    key_traits<src_key>::append(label, key);
+	    S* cur = &node;
+	    while(!cur->search_key && cur->arity() == 1) {
+		std::pair<src_key,S*> next;
+		only fun = { &next };
+		cur->explore(fun, false);
+		key_traits<src_key>::append(label, next.first);
+		cur = next.second;
+	    }
+
+	    // one edge, or several if the key type cannot hold all of label
+	    D* dst = into;
+	    for(size_t ofs = 0; ofs < label.size(); ) {
+		dst_key const edge = key_traits<dst_key>::extract_key(label.c_str(), ofs);
+		D* const sub = new D;
+		dst->attach_node(edge, sub);
+		dst = sub;
+	    }
+	    copy(*dst, *cur);
+	}
+
+	static void copy(D& dst, S& src)
+	{
+	    dst.search_key = src.search_key;
+	    dst.set(src);
+	    copier fun = { &dst };
+	    src.explore(fun, false);
+	}
+    };
+
+    template<class D, class S>
+    struct inserter {
+	D* into;
+	void operator()(const char* word, S& node) const
+	{ into->insert(word).set(node); }
+    };
+
+    template<class D, class S>
+    void build(D& into, S& from, bool, bool)
+    {
+	copier<typename D::trie_type,S>::copy(into, from);
+    }
+
+    template<class D, class S, class X, class Y>
+    void build(D& into, S& from, X, Y)
+    {
+	inserter<typename D::trie_type,S> ins = { &into };
+	for_each_word(from, ins);
+    }
+}
+
+template<class Dst, class Src>
+Dst* patricia(Src& src)
+{
+    typedef typename Src::trie_type trie_type;
+    trie_type& from = src;
+    Dst* const into = new Dst;
+    compact_impl::build(*into, from, into->search_key, from.search_key);
+    return into;
+}
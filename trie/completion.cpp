@@ -0,0 +1,179 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include <queue>
+#include <string>
+
+#include "impl/base.h"
+#include "basis.cpp"
+#include "cursor.cpp"
+
+/* top-k completion of a prefix by weight
+
+   use as completion< simple_trie<ranked<W>,Link,Key> >; optimize() stores
+   in every node the largest weight found in its subtree, and search_top()
+   expands nodes best-first on that bound, so subtrees that cannot beat
+   the k-th result are never visited.
+
+   insert(str, weight) keeps the bounds up to date; after assigning
+   weights through operator[] or info, call optimize() again. */
+
+template<class W>
+struct ranked {
+    typedef W weight_type;
+    W weight;
+    W bound;   // max. weight in the subtree
+
+    ranked(W weight = W()) : weight(weight), bound(weight) { }
+    operator W() const { return weight; }
+
+    ranked& operator=(W w)
+    {
+	weight = w;
+	if(bound < w) bound = w;
+	return *this;
+    }
+};
+
+template<class Trie>
+struct completion : Trie {
+    typedef typename Trie::trie_type node_type;
+    typedef typename Trie::key_type key_type;
+    typedef typename Trie::info_type::weight_type weight_type;
+    typedef std::pair<const node_type*,std::string> result;
+
+    void optimize()
+    {
+	Trie::optimize();
+	annotate(*this);
+    }
+
+    using Trie::insert;
+
+    template<class S>
+    node_type& insert(S str, weight_type weight)
+    {
+	node_type& leaf = Trie::insert(str);
+	leaf.info = weight;
+	// a split edge may have put new nodes on the path, so redo it bottom-up
+	std::vector<node_type*> path(1, this);
+	size_t ofs = 0;
+	while(node_type* next = str[ofs]? path.back()->find_node(str, ofs, false) : 0)
+	    path.push_back(next);
+	for( ; !path.empty(); path.pop_back())
+	    rebound(*path.back());
+	return leaf;
+    }
+
+    // the k heaviest words starting with prefix, heaviest first
+    template<class S>
+    std::vector<result> search_top(S prefix, size_t k)
+    {
+	std::vector<result> res;
+	cursor<node_type> cur(this);
+	size_t len = 0;
+	while(prefix[len] && cur.step(prefix[len]))
+	    ++len;
+	std::string rest;
+	node_type* const top = prefix[len]? 0 : cur.subtree(&rest);
+	if(!top || !k)
+	    return res;
+
+	std::string const base = std::string(key_data(prefix), len) + rest;
+	std::vector<trail> trails;
+	std::priority_queue<entry> open;
+	entry const start = { top->info.bound, top, -1, false };
+	open.push(start);
+	while(!open.empty() && res.size() < k) {
+	    entry const e = open.top();
+	    open.pop();
+	    if(e.word) {
+		res.push_back(result(e.node, spell(base, trails, e.trail)));
+		continue;
+	    }
+	    if(e.node->search_key) {
+		entry const w = { e.node->info.weight, e.node, e.trail, true };
+		open.push(w);
+	    }
+	    expand fun = { &open, &trails, e.trail };
+	    e.node->explore(fun, false);
+	}
+	return res;
+    }
+
+private:
+    struct trail {
+	int parent;
+	key_type key;
+    };
+
+    struct entry {
+	weight_type prio;
+	node_type* node;
+	int trail;
+	bool word;
+
+	// heaviest first; on a tie, report words before expanding subtrees
+	bool operator<(const entry& other) const
+	{ return prio < other.prio || !(other.prio < prio) && word < other.word; }
+    };
+
+    struct expand {
+	std::priority_queue<entry>* open;
+	std::vector<trail>* trails;
+	int parent;
+	void operator()(key_type key, node_type& child) const
+	{
+	    trail const t = { parent, key };
+	    trails->push_back(t);
+	    entry const e = { child.info.bound, &child, int(trails->size())-1, false };
+	    open->push(e);
+	}
+    };
+
+    static std::string spell(const std::string& base, const std::vector<trail>& trails, int i)
+    {
+	std::vector<int> chain;
+	for( ; i >= 0; i = trails[i].parent)
+	    chain.push_back(i);
+	std::string word(base);
+	while(!chain.empty()) {
+	    key_traits<key_type>::append(word, trails[chain.back()].key);
+	    chain.pop_back();
+	}
+	return word;
+    }
+
+    struct bounder {
+	weight_type* best;
+	void operator()(key_type, node_type& child) const
+	{
+	    weight_type const w = annotate(child);
+	    if(*best < w) *best = w;
+	}
+    };
+
+    static weight_type annotate(node_type& node)
+    {
+	weight_type best = node.search_key? node.info.weight : weight_type();
+	bounder fun = { &best };
+	node.explore(fun, false);
+	return node.info.bound = best;
+    }
+
+    struct maximum {
+	weight_type* best;
+	void operator()(key_type, node_type& child) const
+	{ if(*best < child.info.bound) *best = child.info.bound; }
+    };
+
+    // recompute the bound of a node from those of its children
+    static void rebound(node_type& node)
+    {
+	weight_type best = node.search_key? node.info.weight : weight_type();
+	maximum fun = { &best };
+	node.explore(fun, false);
+	node.info.bound = best;
+    }
+};
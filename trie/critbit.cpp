@@ -0,0 +1,241 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "basis.cpp"
+#include "impl/base.h"
+
+ /* A crit-bit tree (a binary patricia trie) for exact lookups: every
+    internal node holds the position of the first bit in which the words
+    below it differ, and two children. Words are compared as if padded
+    with '\0'. There are no child arrays, and a lookup tests one bit per
+    level and compares the complete word only once.
+
+    As in Morrison's PATRICIA, the words are not kept in separate leaves:
+    every internal node holds the leftmost word of its right subtree, and
+    the root holds the smallest word and has the tree as its only child.
+    So there is exactly one node per word, and a missing child stands for
+    a leaf; its word is in the node where the search last went right.
+    Inserting can therefore move a word to another node, as in trie<>.
+
+    This offers the interface used by turbo<>, the statistics walker and
+    the serializer; edges are keyed by the bit and carry no characters.
+    A search has to start at the root, so turbo<> gets no jumps out of it
+    (its Bloom filter and exact index still apply). The critical bits are
+    not stored; they are recomputed when the tree is read back in, so a
+    search writes nothing. Fuzzy search is not supported. */
+
+template<> struct key_traits<bool> {
+    static size_t length(bool)                    { return 0; }
+    static void append(std::string&, bool)        { }
+};
+
+template<class T = void>
+struct critbit : value<T> {
+    typedef critbit link;
+    typedef critbit* pointer;
+    typedef critbit& reference;
+    typedef bool key_type;
+    typedef critbit trie_type;
+    enum { full_key = true };
+
+    const char* search_key;
+    critbit* child[2];
+    unsigned byte;
+    unsigned char mask;         // all bits set, except the critical one; 0 if not numbered
+
+    critbit()
+    : search_key(), byte(), mask()
+    { child[0] = child[1] = 0; }
+
+    template<class S>
+    bool match_tail(S str, size_t i=0) const
+    {
+        do {
+            if(search_key[i] != str[i]) return false;
+        } while(str[i++]);
+        return true;
+    }
+
+    template<class S>
+    const critbit* search(S str, size_t=0) const
+    {
+	if(!search_key) return 0;
+	const critbit* const best = closest(this, str, key_length(str));
+	return best->match_tail(str)? best : 0;
+    }
+
+    template<class S>
+    critbit& insert(S str, size_t=0)
+    {
+	size_t const len = key_length(str);
+	if(!search_key)
+	    return search_key = own_key(str, len), *this;
+	number();
+
+	// find the first bit in which str differs from its closest match
+	critbit* const best = closest(this, str, len);
+	const char* const key = best->search_key;
+	unsigned pos = 0;
+	while(pos < len && key[pos] == str[pos]) ++pos;
+	if(pos == len && !key[pos])
+	    return *best;
+	unsigned char const crit = critical(key[pos], pos < len? str[pos] : 0);
+	bool const side = (1 + (crit | key[pos]&0xFF)) >> 8;
+
+	// the new node goes above the first one that tests a later bit
+	critbit* owner = this;
+	critbit** slot = &child[0];
+	while(critbit* const cur = *slot) {
+	    if(cur->byte > pos || cur->byte == pos && cur->mask > crit) break;
+	    bool const dir = direction(*cur, str, len);
+	    if(dir) owner = cur;
+	    slot = &cur->child[dir];
+	}
+
+	critbit* const node = new critbit;
+	node->byte = pos;
+	node->mask = crit;
+	node->child[side] = *slot;
+	*slot = node;
+	if(!side)
+	    return node->search_key = own_key(str, len), *node;
+	// the new word is left of the subtree, so it takes its place
+	node->search_key = owner->search_key;
+	node->set(*owner);
+	owner->search_key = own_key(str, len);
+	owner->set();
+	return *owner;
+    }
+
+    typename value<T>::reference operator[](const char* str)
+    { return insert(str).info; }
+
+    /* link interface */
+
+    template<class S>
+    pointer find_node(S, size_t&, bool=0)
+    {
+	return 0;
+    }
+
+    template<class S>
+    const critbit* find_node(S, size_t&, bool=0) const
+    {
+	return 0;
+    }
+
+    void attach_node(bool side, pointer p)
+    {
+	child[side] = p;
+	mask = 0;
+    }
+
+    template<class F>
+    void explore(F fun, bool=0)
+    {
+	if(child[0]) fun(false, *child[0]);
+	if(child[1]) fun(true,  *child[1]);
+    }
+
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	if(child[0]) fun(false, static_cast<const critbit&>(*child[0]));
+	if(child[1]) fun(true,  static_cast<const critbit&>(*child[1]));
+    }
+
+    template<class F>
+    void walk(F fun, const size_t lvl=0, bool k=false)
+    {
+	if(fun(k,*this,lvl)) {
+	    if(child[0]) child[0]->template walk<F>(fun,lvl+1,false);
+	    if(child[1]) child[1]->template walk<F>(fun,lvl+1,true);
+	}
+    }
+
+    size_t optimize()
+    {
+	number();
+	return count(this);
+    }
+
+    bool empty() const      { return !child[0] && !child[1]; }
+    size_t arity() const    { return !!child[0] + !!child[1]; }
+    void reserve(size_t)    { }
+
+    // recompute the critical bits, as they are not serialized
+    void number()
+    {
+	if(mask) return;
+	mask = 0xFF;
+	if(child[0]) renumber(child[0], this);
+    }
+
+private:
+    template<class S>
+    static bool direction(const critbit& node, S str, size_t len)
+    {
+	unsigned const c = node.byte < len? str[node.byte] & 0xFF : 0;
+	return (1 + (node.mask | c)) >> 8;
+    }
+
+    // the mask for the highest bit in which a and b differ
+    static unsigned char critical(char a, char b)
+    {
+	unsigned bits = (a ^ b) & 0xFF;
+	bits |= bits >> 1;
+	bits |= bits >> 2;
+	bits |= bits >> 4;
+	return (bits & ~(bits >> 1)) ^ 0xFF;
+    }
+
+    // the node holding the word that agrees with str on all tested bits (N may be const)
+    template<class N, class S>
+    static N* closest(N* root, S str, size_t len)
+    {
+	N* owner = root;
+	for(N* cur = root->child[0]; cur; ) {
+	    bool const dir = direction(*cur, str, len);
+	    if(dir) owner = cur;
+	    cur = cur->child[dir];
+	}
+	return owner;
+    }
+
+    template<class S>
+    static const char* own_key(S str, size_t len)
+    {
+	return len? key_copy(str, 0, len) : "";
+    }
+
+    static size_t count(const critbit* node)
+    {
+	return node? 1 + count(node->child[0]) + count(node->child[1]) : 0;
+    }
+
+    static void renumber(critbit* node, const critbit* owner)
+    {
+	// a word on either side: the left one is in the left child, or in the owner of that leaf
+	const char* const a = node->child[0]? node->child[0]->search_key : owner->search_key;
+	const char* const b = node->search_key;
+	unsigned pos = 0;
+	while(a[pos] == b[pos]) ++pos;
+	node->byte = pos;
+	node->mask = critical(a[pos], b[pos]);
+	if(node->child[0]) renumber(node->child[0], owner);
+	if(node->child[1]) renumber(node->child[1], node);
+    }
+};
+
+// see serialize.cpp; the text is never freed
+template<class T>
+void unserialized(critbit<T>& lex, const char*, size_t)
+{
+    lex.number();
+}
+
+template<class T>
+size_t memused(critbit<T> const& t, size_t allocated(size_t) = allocated)
+{
+    return allocated(sizeof t) + memused(t.search_key, allocated);
+}
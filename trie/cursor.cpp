@@ -0,0 +1,163 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <string>
+#include "basis.cpp"
+
+ /* A cursor that walks a lexicon one character at a time, for scanning
+    unsegmented text: step(c) reports whether a word ends at the current
+    prefix and whether any longer word is still possible. Once step()
+    returns 0 the prefix is dead and stays so until reset().
+
+    Multi-character edges (char_ptr, char_store<N>) are consumed one
+    character at a time; for trie<> the keys that are stored in nodes
+    along the path are tracked separately, as these may run ahead of the
+    node structure. The trie is never modified. */
+
+template<class T>
+struct cursor {
+    typedef typename T::key_type key_type;
+    enum { word = 1, more = 2 };   // step() result bits
+
+    explicit cursor(T* dict) : dict(dict)
+    {
+	reset();
+    }
+
+    void reset()
+    {
+	path.clear();
+	keys.clear();
+	node = dict;
+	label.clear();
+	pos = 0;
+	arrive();
+    }
+
+    int step(char c)
+    {
+	if(!c || !alive) return alive = 0;
+	path += c;
+	size_t const i = path.size()-1;
+
+	size_t n = 0;
+	for(size_t k=0; k < keys.size(); ++k)
+	    if(key_at(keys[k].first->search_key, i-keys[k].second) == c)
+		keys[n++] = keys[k];
+	keys.resize(n);
+
+	if(!node)
+	    ;
+	else if(pos < label.size())
+	    node = label[pos++] == c? node : 0;
+	else if(node = child(node, c, key_type()))
+	    pos = 1;
+	if(node && pos == label.size()) arrive();
+	return status();
+    }
+
+    int state() const      { return alive; }
+    size_t length() const  { return path.size(); }
+
+    // the node holding the current prefix as a word, or 0
+    const T* match() const
+    {
+	size_t const i = path.size();
+	for(size_t k=0; k < keys.size(); ++k)
+	    if(!key_at(keys[k].first->search_key, i-keys[k].second))
+		return keys[k].first;
+	return node && pos == label.size() && ends(node->search_key)? node : 0;
+    }
+
+    // the node below which the continuations of the prefix lie, or 0; the
+    // part of its edge that is not yet consumed is stored in rest. (for a
+    // trie<> this does not cover the keys stored along the path)
+    T* subtree(std::string* rest = 0) const
+    {
+	if(rest && node) rest->assign(label, pos, std::string::npos);
+	return node;
+    }
+
+private:
+    T* const dict;
+    std::string path;
+    std::vector< std::pair<const T*,size_t> > keys;  // (node, offset of its stored key)
+    T* node;                                          // 0 once no trie path is left
+    std::string label;                                // edge leading into node
+    size_t pos;                                       // characters of label consumed
+    int alive;
+
+    void arrive()
+    {
+	if(stores(node->search_key))
+	    keys.push_back(std::make_pair(node, T::full_key? 0 : path.size()));
+	alive = status();
+    }
+
+    int status()
+    {
+	size_t const i = path.size();
+	int res = match()? word : 0;
+	if(node && (pos < label.size() || !node->empty()))
+	    res |= more;
+	for(size_t k=0; k < keys.size() && !(res&more); ++k)
+	    if(key_at(keys[k].first->search_key, i-keys[k].second))
+		res |= more;
+	return alive = res;
+    }
+
+    static bool stores(bool)                    { return false; }
+    static bool stores(const char* key)         { return key; }
+    static bool ends(bool key)                  { return key; }
+    static bool ends(const char*)               { return false; }
+    static char key_at(bool, size_t)            { return 0; }
+    static char key_at(const char* key, size_t i) { return key[i]; }
+
+    // single-character edges can simply be looked up
+    T* child(T* node, char c, char)
+    {
+	char const str[] = { c, '\0' };
+	size_t ofs = 0;
+	label = c;
+	return node->find_node(str, ofs, false);
+    }
+
+    struct finder {
+	char const c;
+	T** found;
+	std::string* label;
+	void operator()(key_type key, T& node) const
+	{
+	    if(!*found && char(key) == c) {
+		*found = &node;
+		label->clear();
+		key_traits<key_type>::append(*label, key);
+	    }
+	}
+    };
+
+    template<class K>
+    T* child(T* node, char c, K)
+    {
+	T* found = 0;
+	finder f = { c, &found, &label };
+	node->explore(f, false);
+	return found;
+    }
+};
+
+// length of the longest word in the lexicon that is a prefix of str, or 0
+template<class T, class S>
+size_t longest_prefix(T& lexicon, S str, const typename T::trie_type** match = 0)
+{
+    cursor<typename T::trie_type> cur(&lexicon);
+    size_t best = 0;
+    if(match) *match = cur.match();
+    for(size_t i=0; str[i] && (cur.state() & cur.more); ++i)
+	if(cur.step(str[i]) & cur.word) {
+	    best = i+1;
+	    if(match) *match = cur.match();
+	}
+    return best;
+}
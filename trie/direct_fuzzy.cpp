@@ -118,11 +118,11 @@ struct direct_fuzzy : Trie {
     typedef typename Trie::link link;
     typedef std::pair<const direct_fuzzy*,unsigned> result;
 
-    static unsigned match(const Penalties& cost, bool, const char* str, unsigned limit=-1)
+    static unsigned match(const Penalties& cost, bool, const char* str, const char* end, unsigned limit=-1)
     { 
 	unsigned dist = 0;
-	while(char c = *str++)
-	    if((dist += cost.del(c)) > limit) break;
+	while(str != end)
+	    if((dist += cost.del(*str++)) > limit) break;
 	return dist;
     }
 
@@ -131,13 +131,13 @@ struct direct_fuzzy : Trie {
 	return std::min(std::min(a,b), c);
     }
 
-    static unsigned match(const Penalties& cost, const char* pattern, const char* str, unsigned limit=-1)
+    static unsigned match(const Penalties& cost, const char* pattern, const char* str, const char* end, unsigned limit=-1)
     { 
 	size_t pat_size = std::strlen(pattern);
 	#if 0
 	std::vector<unsigned> tab(pat_size+1);
 	#else
-	static unsigned tab[4096];
+	unsigned tab[4096];   // per call, so searches can run in parallel
 	#endif
 	// initialize dynamic programming matrix
 	unsigned dist = 0;
@@ -147,7 +147,8 @@ struct direct_fuzzy : Trie {
 	}
 
 	// run through the remainder of the string
-	while(char c = *str++) {
+	while(str != end) {
+	    char const c = *str++;
 	    unsigned old_left = tab[0];
 	    unsigned new_left = tab[0] += cost.del(c);
 	    for(size_t i=1; i <= pat_size; ++i) {
@@ -163,12 +164,12 @@ struct direct_fuzzy : Trie {
 	return tab[pat_size];
     }
 
-    unsigned match_tail(const Penalties& cost, const char* str, size_t ofs=0)
+    unsigned match_tail(const Penalties& cost, const char* str, const char* end, size_t ofs=0) const
     {
 	if(Trie::full_key)
-	    return match(cost, search_key+ofs, str);
+	    return match(cost, search_key+ofs, str, end);
 	else
-	    return match(cost, search_key, str);
+	    return match(cost, search_key, str, end);
     }
 
     /*
@@ -181,8 +182,9 @@ struct direct_fuzzy : Trie {
     }
     */
 
+    // as in fuzzy<>: the search functions only read the trie, and can run in parallel on a const one
     using Trie::search;
-    const Trie* search(const char* str, unsigned limit)
+    const Trie* search(const char* str, unsigned limit) const
     {
 	std::vector<result> res;
 	search_fuzzy(res, str, limit, 2);
@@ -192,7 +194,10 @@ struct direct_fuzzy : Trie {
 	    return res[0].first;
     }
 
-    std::vector<result> search_fuzzy(const char* str, unsigned limit, char mode=true, const Penalties& dist_table = Penalties())
+    const Trie* search(const char* str, unsigned limit)
+    { return static_cast<const direct_fuzzy*>(this)->search(str, limit); }
+
+    std::vector<result> search_fuzzy(const char* str, unsigned limit, char mode=true, const Penalties& dist_table = Penalties()) const
     {
 	std::vector<result> res;
 	search_fuzzy(res, str, limit, mode, dist_table);
@@ -206,34 +211,63 @@ struct direct_fuzzy : Trie {
     typedef std::set<memo_key> memo_table;
 #endif
 
-    void search_fuzzy(std::vector<result>& res, const char* str, unsigned limit, char mode=true, const Penalties& dist_table = Penalties())
+    void search_fuzzy(std::vector<result>& res, const char* str, unsigned limit, char mode=true, const Penalties& dist_table = Penalties()) const
+    {
+	memo_table memo;
+	search_recursive(memo, res, str, str+std::strlen(str), 0, 0, limit, mode, dist_table);
+    }
+
+    const Trie* search(char_view str, unsigned limit) const
+    {
+	std::vector<result> res;
+	search_fuzzy(res, str, limit, 2);
+	if(res.empty())
+	    return 0;
+	else
+	    return res[0].first;
+    }
+
+    const Trie* search(char_view str, unsigned limit)
+    { return static_cast<const direct_fuzzy*>(this)->search(str, limit); }
+
+    std::vector<result> search_fuzzy(char_view str, unsigned limit, char mode=true, const Penalties& dist_table = Penalties()) const
+    {
+	std::vector<result> res;
+	search_fuzzy(res, str, limit, mode, dist_table);
+	return res;
+    }
+
+    void search_fuzzy(std::vector<result>& res, char_view str, unsigned limit, char mode=true, const Penalties& dist_table = Penalties()) const
     {
 	memo_table memo;
-	search_recursive(memo, res, str, 0, 0, limit, mode, dist_table);
+	const char* const begin = str.data? str.data : "";
+	search_recursive(memo, res, begin, begin+key_length(str), 0, 0, limit, mode, dist_table);
     }
 
     struct feeder {
 	const Penalties& cost;
 #if BEST_FIRST
-	struct held { direct_fuzzy* trie; const char* str; size_t ofs; };
+	struct held { const direct_fuzzy* trie; const char* str; size_t ofs; };
 	std::vector<held>* const delayed;
 #endif
 	memo_table& memo;
 	std::vector<result>& results;
 	const char* const str;
+	const char* const end;
 	size_t const ofs;
 	unsigned const dist;
 	unsigned& limit;
 	char const best_only;
 
-	void operator()(char c, Trie& entry) const
+	void operator()(char c, const Trie& entry) const
 	{ 
 //printf("{open:%*c:%d}\n", ofs*4, ' ', entry.search_key);
-	    direct_fuzzy* trie = static_cast<direct_fuzzy*>(&entry);
+	    const direct_fuzzy* trie = static_cast<const direct_fuzzy*>(&entry);
 	    const char* inp = str;
 	    unsigned ndist = dist;
 	    unsigned penalty;
-	    while(char ct = *inp++) {
+	    while(inp != end) {
+		char const ct = *inp++;
 		if(ndist+(penalty=cost.rpl(ct, c)) <= limit) 
 //printf("%*c", ofs*4, ' '), printf("[%c==%c]\n", c, ct),
 		    enqueue(trie, inp, ofs+1, ndist+penalty);
@@ -246,16 +280,16 @@ struct direct_fuzzy : Trie {
 //printf("%*c", ofs*4, ' '), printf("[del %c]\n", ct);
 	    } 
 	    if(ndist+(penalty=cost.ins(c)) <= limit) 
-		enqueue(trie, inp-1, ofs+1, ndist+penalty);
+		enqueue(trie, inp, ofs+1, ndist+penalty);
 	}
 
-	void enqueue(direct_fuzzy* entry, const char* str, size_t ofs, unsigned ndist) const
+	void enqueue(const direct_fuzzy* entry, const char* str, size_t ofs, unsigned ndist) const
 	{
 #if BEST_FIRST
 	    if(ndist == dist) {
 		if(!memo.insert(memo_key(entry, str)).second) 
 		    return;
-		feeder next = { cost, delayed, memo, results, str, ofs, ndist, limit, best_only };
+		feeder next = { cost, delayed, memo, results, str, end, ofs, ndist, limit, best_only };
 		next.visit(entry);
 		entry->template explore<feeder&>(next, 0);
 	    } else if (ndist <= limit) {
@@ -263,15 +297,15 @@ struct direct_fuzzy : Trie {
 		delayed[ndist].push_back(record);
 	    }
 #else
-	    entry->search_recursive(memo, results, str, ofs, ndist, limit, best_only, cost);
+	    entry->search_recursive(memo, results, str, end, ofs, ndist, limit, best_only, cost);
 #endif
 	}
 
-	void visit(direct_fuzzy* entry) 
+	void visit(const direct_fuzzy* entry) 
 	{
             if(!entry->search_key) return;
 
-            unsigned const ndist = dist + entry->match_tail(cost, str, ofs);
+            unsigned const ndist = dist + entry->match_tail(cost, str, end, ofs);
 
             if(ndist <= limit) {
                 result record(entry,ndist);
@@ -315,7 +349,7 @@ struct direct_fuzzy : Trie {
 	friend class direct_fuzzy;
     };
 
-    void search_recursive(memo_table& memo, std::vector<result>& res, const char* str, size_t ofs, unsigned threshold, unsigned& limit, char best_only, const Penalties& dist_table)
+    void search_recursive(memo_table& memo, std::vector<result>& res, const char* str, const char* end, size_t ofs, unsigned threshold, unsigned& limit, char best_only, const Penalties& dist_table) const
     {
 	std::pair<typename memo_table::iterator, bool> lookup = memo.insert(memo_key(this, str));
 	if(!lookup.second) return;
@@ -324,9 +358,9 @@ struct direct_fuzzy : Trie {
 	typedef std::vector<typename feeder::held> bucket_vector;
 	std::vector<bucket_vector> bucket_vec(1+limit); 
 	bucket_vector* const bucket = bucket_vec.data();
-	feeder recurse = { dist_table, bucket, memo, res, str, ofs, threshold, limit, best_only };
+	feeder recurse = { dist_table, bucket, memo, res, str, end, ofs, threshold, limit, best_only };
 #else
-	feeder recurse = { dist_table, memo, res, str, ofs, threshold, limit, best_only };
+	feeder recurse = { dist_table, memo, res, str, end, ofs, threshold, limit, best_only };
 #endif
 	recurse.visit(this);
 
@@ -349,7 +383,7 @@ struct direct_fuzzy : Trie {
 		    continue;
 		}
 #endif
-		feeder next = { dist_table, bucket, memo, res, r.str, r.ofs, threshold, limit, best_only };
+		feeder next = { dist_table, bucket, memo, res, r.str, end, r.ofs, threshold, limit, best_only };
 		next.visit(r.trie);
 		if(threshold > limit)  // late addition
 		    break;
@@ -94,7 +94,7 @@ struct direct_fuzzy : Trie {
 	#if 0
 	std::vector<unsigned> tab(pat_size+1);
 	#else
-	static unsigned tab[4096];
+	unsigned tab[4096];   // per call, so searches can run in parallel
 	#endif
 	// initialize dynamic programming matrix
 	unsigned dist = 0;
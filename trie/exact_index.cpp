@@ -0,0 +1,152 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <string>
+#include "../hash/flex_table.cpp"
+#include "basis.cpp"
+
+ /* A side index that hashes complete words straight to the node holding
+    them, so an exact hit costs one hash probe instead of a walk down the
+    trie. Every entry is checked against the node before it is returned:
+    trie<> moves keys down when a shorter word is inserted, and a stale
+    entry then falls back to a normal search, which points it at the node
+    the word is in now.
+
+    The index only knows about words inserted through it, and words must
+    be erased through it as well: erase() drops the entry, whose node may
+    be handed out again for another word. */
+
+#ifndef EXACT_INDEX
+#define EXACT_INDEX 0
+#endif
+
+template<class T>
+struct exact_index {
+    typedef std::pair<const T*, size_t> entry;   // node, offset for match_tail
+
+    T* const dict;
+    hash_table<entry> tab;
+
+    exact_index(T* dict) : dict(dict)
+    {
+	for_each_word(*dict, adder(*this));
+    }
+
+    template<class S>
+    const T* search(S str)
+    {
+	typename hash_table<entry>::value_type* p = lookup(str);
+	if(!p)
+	    return 0;
+	const T* node = p->second.first;
+	if(node->search_key && node->match_tail(str, p->second.second))
+	    return node;
+	if((node = dict->search(str)))
+	    p->second = entry(node, offset(key_length(str), *node));
+	return node;
+    }
+
+    template<class S>
+    T& insert(S str, const size_t ofs=0)
+    {
+	T& node = dict->insert(str, ofs);
+	add(std::string(key_data(str), key_length(str)).c_str(), node);
+	return node;
+    }
+
+    /* in a trie<>, the words below an erased one can move up a node (see
+       trie<>::erase), so everything below its node is indexed again */
+    template<class S>
+    bool erase(S str)
+    {
+	std::string const word(key_data(str), key_length(str));
+	const T* const node = search(str);
+	if(!node) return false;
+	bool const moves = shifts(node->search_key) && has_heir(*node);
+	size_t const ofs = offset(word.size(), *node);
+	dict->erase(str);
+	tab.erase(word.c_str());
+	if(moves) {
+	    reindex fun = { *this, word.substr(0, ofs) };
+	    for_each_word(const_cast<T&>(*node), fun);
+	}
+	return true;
+    }
+
+private:
+    // hash_table::search(), for keys that need not be NUL-terminated
+    template<class S>
+    typename hash_table<entry>::value_type* lookup(S str)
+    {
+	uint32_t h = 2166136261UL;
+	for(size_t i=0; char c = str[i]; ++i)
+	    h = fnv::hash32(h, c);
+	typename hash_table<entry>::bucket& b = tab.tab[h & tab.tab.size()-1];
+	for(typename hash_table<entry>::iterator p = b.begin(); p != b.end(); ++p) {
+	    size_t i = 0;
+	    while(p->first[i] == str[i] && str[i]) ++i;
+	    if(p->first[i] == str[i]) return &*p;
+	}
+	return 0;
+    }
+
+    // hash_table::insert() keeps an entry that is there already
+    void add(const char* str, const T& node)
+    {
+	entry const e(&node, offset(std::strlen(str), node));
+	if(typename hash_table<entry>::value_type* p = lookup(str))
+	    p->second = e;
+	else
+	    tab.insert(str, e);
+    }
+
+    // where match_tail() starts in a word of len characters
+    static size_t offset(size_t len, const T& node)
+    {
+	return T::full_key? 0 : len - tail(node.search_key);
+    }
+
+    static size_t tail(bool)            { return 0; }
+    static size_t tail(const char* key) { return std::strlen(key); }
+
+    // whether words move between nodes when one is erased
+    static bool shifts(bool)            { return false; }
+    static bool shifts(const char*)     { return true; }
+
+    struct heir {
+	bool* found;
+	template<class K>
+	void operator()(K, const T& child) const { if(child.search_key) *found = true; }
+    };
+
+    static bool has_heir(const T& node)
+    {
+	bool found = false;
+	heir fun = { &found };
+	node.explore(fun, false);
+	return found;
+    }
+
+    // point the entries of the words below a node at where they are now
+    struct reindex {
+	exact_index& index;
+	std::string const prefix;
+	void operator()(const char* word, const T& node) const
+	{
+	    index.add((prefix + word).c_str(), node);
+	}
+    };
+
+    struct adder {
+	exact_index& index;
+	explicit adder(exact_index& index) : index(index) { }
+	void operator()(const char* word, const T& node) { index.add(word, node); }
+    };
+};
+
+template<class T>
+size_t memused(exact_index<T>& index, size_t allocated(size_t) = allocated)
+{
+    return memused(index.tab);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cctype>
+#include <cstring>
+#include <string>
+
+#include "impl/base.h"
+#include "basis.cpp"
+
+/* a case-insensitive lexicon that remembers how words were spelled
+
+   use as folded< simple_trie<spellings,Link,Key> >, or for fuzzy search
+   folded< fuzzy< simple_trie<spellings,Link,Key>, caseless<nfa> > >;
+   the trie is indexed on the lower case form of every word, so "AARON"
+   and "Aaron" share a single path, and the node of a word lists all the
+   spellings that were inserted for it; this list is left empty if the
+   only spelling is the lower case one. lookups fold the query; the
+   caseless<> automata accept either case, so fuzzy queries need not be
+   folded at all.
+
+   the spellings are pointers, so they cannot be serialized. */
+
+struct spellings {
+    char* list;   // each form NUL-terminated, and an empty one at the end
+
+    spellings() : list() { }
+
+    // the first form, or 0 if there is none
+    const char* first() const
+    { return list; }
+
+    // the form after the one at p, or 0
+    static const char* next(const char* p)
+    {
+	p += std::strlen(p)+1;
+	return *p? p : 0;
+    }
+
+    bool has(const char* str, size_t len) const
+    {
+	for(const char* p = first(); p; p = next(p))
+	    if(std::strlen(p) == len && std::memcmp(p, str, len) == 0) return true;
+	return false;
+    }
+
+    void add(const char* str, size_t len)
+    {
+	if(has(str, len)) return;
+	size_t old = 0;
+	for(const char* p = first(); p; p = next(p))
+	    old = p + std::strlen(p)+1 - list;
+	char* const tmp = new char[old+len+2];
+	if(old) std::memcpy(tmp, list, old);
+	std::memcpy(tmp+old, str, len);
+	tmp[old+len] = tmp[old+len+1] = '\0';
+	delete[] list;
+	list = tmp;
+    }
+};
+
+template<class Trie>
+struct folded : Trie {
+    typedef typename Trie::trie_type node_type;
+
+    template<class S>
+    node_type& insert(S str)
+    {
+	std::string const key = fold(str);
+	const node_type* const old = Trie::search(key.c_str());
+	node_type& node = Trie::insert(key.c_str());
+	bool const plain = key.compare(0, key.size(), key_data(str), key.size()) == 0;
+	if(old && !node.info.first() && !plain)
+	    node.info.add(key.data(), key.size());
+	if(old? node.info.first() != 0 : !plain)
+	    node.info.add(key_data(str), key.size());
+	return node;
+    }
+
+    // case-insensitive
+    template<class S>
+    const node_type* search(S str)
+    {
+	return Trie::search(fold(str).c_str());
+    }
+
+    // only if this spelling was inserted
+    template<class S>
+    const node_type* search_cased(S str)
+    {
+	const node_type* const node = search(str);
+	if(!node) return 0;
+	if(!node->info.first())
+	    return fold(str).compare(0, std::string::npos, key_data(str), key_length(str)) == 0? node : 0;
+	return node->info.has(key_data(str), key_length(str))? node : 0;
+    }
+
+    template<class S>
+    static std::string fold(S str)
+    {
+	std::string key(key_data(str), key_length(str));
+	for(size_t i=0; i < key.size(); ++i)
+	    key[i] = std::tolower(key[i]&0xFF);
+	return key;
+    }
+};
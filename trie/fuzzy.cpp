@@ -23,6 +23,7 @@ struct fuzzy : Trie {
     typedef typename Trie::link link;
     typedef std::pair<const fuzzy*,unsigned> result;
 
+    typedef nfa nfa_type;
     typedef typename nfa::state nfastate;
 
     static unsigned match(bool, const nfa& fsm, const nfastate& state)
@@ -48,7 +49,7 @@ struct fuzzy : Trie {
 	    return fsm.accepts_dist(state);
     }
 
-    unsigned match_tail(const nfa& fsm, const nfastate& state, size_t ofs=0)
+    unsigned match_tail(const nfa& fsm, const nfastate& state, size_t ofs=0) const
     {
 	if(Trie::full_key)
 	    return match(search_key+ofs, fsm, state);
@@ -66,8 +67,12 @@ struct fuzzy : Trie {
     }
     */
 
+    /* the search functions only read the trie, and keep their state in
+       the call, so a const lexicon can be searched by several threads.
+       search(str, limit) also has a non-const version, or else the exact
+       Trie::search(str, ofs) would be a better match on a non-const one */
     using Trie::search;
-    const Trie* search(const char* str, unsigned limit)
+    const Trie* search(const char* str, unsigned limit) const
     {
 	std::vector<result> res;
 	search_fuzzy(res, str, limit, 2);
@@ -77,26 +82,56 @@ struct fuzzy : Trie {
 	    return res[0].first;
     }
 
-    std::vector<result> search_fuzzy(const char* str, unsigned limit=nfa::max_distance, char mode=true)
+    const Trie* search(const char* str, unsigned limit)
+    { return static_cast<const fuzzy*>(this)->search(str, limit); }
+
+    std::vector<result> search_fuzzy(const char* str, unsigned limit=nfa::max_distance, char mode=true) const
     {
 	std::vector<result> res;
 	search_fuzzy(res, str, limit, mode);
 	return res;
     }
 
-    void search_fuzzy(std::vector<result>& res, const char* str, unsigned limit=nfa::max_distance, char mode=true)
+    void search_fuzzy(std::vector<result>& res, const char* str, unsigned limit=nfa::max_distance, char mode=true) const
     {
 	nfa fsm(str,limit);
 	nfastate init = fsm.start(); 
 	search_nfa(res, fsm, init, mode);
     }
 
+    const Trie* search(char_view str, unsigned limit) const
+    {
+	std::vector<result> res;
+	search_fuzzy(res, str, limit, 2);
+	if(res.empty())
+	    return 0;
+	else
+	    return res[0].first;
+    }
+
+    const Trie* search(char_view str, unsigned limit)
+    { return static_cast<const fuzzy*>(this)->search(str, limit); }
+
+    std::vector<result> search_fuzzy(char_view str, unsigned limit=nfa::max_distance, char mode=true) const
+    {
+	std::vector<result> res;
+	search_fuzzy(res, str, limit, mode);
+	return res;
+    }
+
+    void search_fuzzy(std::vector<result>& res, char_view str, unsigned limit=nfa::max_distance, char mode=true) const
+    {
+	nfa fsm(str.data, key_length(str), limit);
+	nfastate init = fsm.start(); 
+	search_nfa(res, fsm, init, mode);
+    }
+
     struct feeder {
 #if SEARCH_ORDER
 	#if SEARCH_ORDER > 2
-	struct held { fuzzy* trie; nfastate state; size_t ofs; };
+	struct held { const fuzzy* trie; nfastate state; size_t ofs; };
 	#else
-	struct held { fuzzy* trie; nfastate state; unsigned dist; };
+	struct held { const fuzzy* trie; nfastate state; size_t ofs; unsigned dist; };
 	#endif
 	std::vector<held>* const delayed;
 #endif
@@ -106,41 +141,72 @@ struct fuzzy : Trie {
 	size_t const ofs;
 	unsigned const dist;
 	char const best_only;
+	// the state after the first character of the previous edge, which
+	// is often shared by the next one
+	mutable char last;
+	mutable nfastate after;
+	mutable unsigned after_dist;
+
+	// feed all characters on an edge; len is their number
+	unsigned feed(char c, nfastate& next, size_t& len) const
+	{
+	    len = 1;
+	    return fsm.feed(state, c, next);
+	}
+
+	template<class K>
+	unsigned feed(K key, nfastate& next, size_t& len) const
+	{
+	    if(key[0] != last) {
+		last = key[0];
+		after_dist = fsm.feed(state, last, after);
+	    }
+	    len = key_traits<K>::length(key);
+	    if(len == 1 || after_dist > fsm.height) 
+		return next = after, after_dist;
+	    unsigned dist = fsm.feed(after, key[1], next);
+	    for(size_t i=2; i < len && dist <= fsm.height; ++i)
+		dist = next.feed(fsm, key[i]);
+	    return dist;
+	}
 
-	void operator()(char c, Trie& entry) const
+	template<class K>
+	void operator()(K key, const Trie& entry) const
 	{ 
-	    fuzzy* trie = static_cast<fuzzy*>(&entry);
+	    const fuzzy* trie = static_cast<const fuzzy*>(&entry);
 	    nfastate next_state;
+	    size_t len;
 #if SEARCH_ORDER
 	    unsigned ndist;
-	    if((ndist=fsm.feed(state, c, next_state)) <= fsm.height) {
+	    if((ndist=feed(key, next_state, len)) <= fsm.height) {
 		if(ndist == dist) {
 		    #if SEARCH_ORDER > 4
-		    feeder next = { delayed, results, fsm, next_state, ofs+1, dist, best_only };
+		    feeder next = { delayed, results, fsm, next_state, ofs+len, dist, best_only };
 		    next.visit(trie);
 		    trie->template explore<feeder&>(next, 0);
 		    #else
-		    trie->search_nfa(results, fsm, next_state, best_only, ofs+1, dist);
+		    trie->search_nfa(results, fsm, next_state, best_only, ofs+len, dist);
 		    #endif
 		} else {
 		    #if SEARCH_ORDER > 2
-		    held cont = { trie, next_state, ofs+1 };
+		    held cont = { trie, next_state, ofs+len };
 		    delayed[ndist].push_back(cont);
 		    #else
-		    held cont = { trie, next_state, ndist };
+		    held cont = { trie, next_state, ofs+len, ndist };
 		    delayed->push_back(cont);
 		    #endif
 		}
 	    }
 #else
-	    if(fsm.feed(state, c, next_state) <= fsm.height)
-		trie->search_nfa(results, fsm, next_state, best_only, ofs+1);
+	    if(feed(key, next_state, len) <= fsm.height)
+		trie->search_nfa(results, fsm, next_state, best_only, ofs+len);
 #endif
 	}
 
-	void visit(fuzzy* const entry) const
+	void visit(const fuzzy* const entry) const
 	{
-	    if(!entry->search_key) return;
+	    // as in simple_trie::search(), for a word inserted while this runs
+	    if(!__atomic_load_n(&entry->search_key, __ATOMIC_ACQUIRE)) return;
 
 	    unsigned dist = entry->match_tail(fsm, state, ofs);
 
@@ -159,7 +225,7 @@ struct fuzzy : Trie {
 	friend class fuzzy;
     };
 
-    void search_nfa(std::vector<result>& results, nfa& fsm, nfastate const& state, char best_only, size_t ofs=0, size_t threshold=0)
+    void search_nfa(std::vector<result>& results, nfa& fsm, nfastate const& state, char best_only, size_t ofs=0, size_t threshold=0) const
     {
 #if SEARCH_ORDER
 	/* one too many, since we never insert at the same distance level */
@@ -180,7 +246,7 @@ struct fuzzy : Trie {
 		next.visit(r.trie);
 		r.trie->template explore<feeder&>(next, 0);
 		#else
-		r.trie->search_nfa(results,fsm,r.state,best_only,ofs+1,threshold);
+		r.trie->search_nfa(results,fsm,r.state,best_only,r.ofs,threshold);
 		if(threshold > fsm.height) break;
 		#endif
 	    }
@@ -191,7 +257,7 @@ struct fuzzy : Trie {
 	for(size_t i=0; i < recurse.delayed->size(); ++i) {
 	    typename feeder::held& r = (*recurse.delayed)[i];
 	    if(r.dist <= fsm.height)
-		r.trie->search_nfa(results,fsm,r.state,best_only,ofs+1,r.dist);
+		r.trie->search_nfa(results,fsm,r.state,best_only,r.ofs,r.dist);
 	    #if SEARCH_ORDER > 1
 	    else
 		break;
@@ -0,0 +1,296 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+#include "base.h"
+#include "../../util/containers.h"
+
+/* AtomicList: LinkedList for several threads that insert into one trie at
+   once, without a lock. next and sib only change by compare-and-swap: a
+   new child goes in front of the list, and an edge is split by putting a
+   new node in the place of the old one, with a copy of the old one below
+   it. The old node is frozen first, by marking its next and sib (the low
+   bit), so nothing can be added to it any more; whoever finds a frozen
+   node in a list replaces it by a copy before going on, so no thread ever
+   waits for another.
+
+   For simple_trie<void,AtomicList,K>. Replaced nodes are not freed, as
+   other threads may still be in them, and a value assigned to the node
+   insert() returned may end up in one of those. Searches can run at the
+   same time. optimize(), sort(), erase() and detach_node() are for when
+   no one is inserting. Uses the __atomic builtins of gcc and clang. */
+
+template<class T, class K>
+struct AtomicList {
+    typedef T* pointer;
+    typedef T& reference;
+    typedef AtomicList link;
+
+    pointer next, sib;
+    K key;
+
+    AtomicList() : next(), sib(), key() { }
+
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool=false)
+    {
+	for(pointer p = child(next); p; p = child(p->sib))
+	    if(p->key == str[ofs])
+		return key_traits<K>::match_key(p->key, str, ofs)? p : 0;
+	return 0;
+    }
+
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	for(const T* p = child(next); p; p = child(p->sib))
+	    if(p->key == str[ofs])
+		return key_traits<K>::match_key(p->key, str, ofs)? p : 0;
+	return 0;
+    }
+
+    void attach_node(K k, pointer p)
+    {
+	p->key = k;
+	p->sib = next;
+	next = p;
+    }
+
+    std::pair<K,pointer> detach_node(char ch)
+    {
+	for(pointer* p = &next; *p; p = &(*p)->sib)
+	    if((*p)->key == ch) {
+		pointer const q = *p;
+		*p = q->sib;
+		return std::make_pair(q->key, q);
+	    }
+	return std::make_pair(K(), pointer());
+    }
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
+    {
+	for(;;) {
+	    pointer const head = load(next);
+	    if(marked(head))
+		return *this_T();    // frozen; the caller sees that and starts over
+	    pointer p = head;
+	    while(p && !frozen(p) && p->key != str[ofs])
+		p = child(p->sib);
+	    size_t end = ofs;
+	    if(p && frozen(p)) {
+		pointer const c = copy(p);
+		if(!replace(p, c)) delete c;
+	    } else if(!p) {
+		K const k = key_traits<K>::extract_key(str, end);
+		pointer n;
+		reference rn = T::create(n, str, end);
+		n->key = k;
+		n->sib = head;
+		pointer expected = head;
+		if(__atomic_compare_exchange_n(&next, &expected, n, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		    return rn;
+		discard(n);
+	    } else if(key_traits<K>::match_key(p->key, str, end)) {
+		reference rn = p->insert(str, end);
+		// if p was not frozen yet, whoever freezes it copies what was just done
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if(!frozen(p))
+		    return rn;
+	    } else if(T* rn = split(p, str, ofs, end))
+		return *rn;
+	}
+    }
+
+    void reserve(size_t) const { }
+
+    bool empty() const
+    {
+	return !child(next);
+    }
+
+    size_t arity() const
+    {
+	size_t acc = 0;
+	for(pointer p = child(next); p; p = child(p->sib)) ++acc;
+	return acc;
+    }
+
+    std::pair<K,pointer> successor() const
+    {
+	pointer const p = child(next);
+	return p && !child(p->sib)? std::make_pair(p->key, p) : std::make_pair(K(),pointer());
+    }
+
+    /* utilities */
+    T* this_T()
+    {
+	return static_cast<T*>(this);
+    }
+
+    template<class F>
+    void explore(F fun, bool=0)
+    {
+	for(pointer p = child(next); p; p = child(p->sib))
+	    fun(p->key, *p);
+    }
+
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	for(const T* p = child(next); p; p = child(p->sib))
+	    fun(p->key, *p);
+    }
+
+    template<class F>
+    void walk(F fun, const size_t ofs=0)
+    {
+	if(fun(key,*this_T(),ofs))
+	    for(pointer p = child(next); p; p = child(p->sib))
+		p->template walk<F>(fun,ofs+1);
+    }
+
+    size_t optimize()
+    {
+	return optimize(no_profile());
+    }
+
+    // as in LinkedList
+    template<class W>
+    size_t optimize(const W& hits)
+    {
+	typedef std::pair<size_t,size_t> rank;
+	std::vector<std::pair<rank, pointer> > n;
+	size_t acc = !!this_T()->search_key;
+
+	for(pointer p = next; p; p=p->sib) {
+	    size_t card = optimize_subtree(*p, hits);
+	    n.push_back(std::make_pair(rank(hits(p),card),p));
+	    acc += card;
+	}
+
+	std::sort(n.begin(), n.end(), onkey(&std::pair<rank,pointer>::first));
+
+	next = 0;
+	for(size_t i=0; i < n.size(); ++i) {
+	    pointer& p = n[i].second;
+	    p->sib = next;
+	    next = p;
+	}
+	return acc;
+    }
+
+    void sort()
+    {
+	std::vector<std::pair<K, pointer> > n;
+
+	for(pointer p = next; p; p=p->sib) {
+	    p->sort();
+	    n.push_back(std::pair<K,pointer>(p->key,p));
+	}
+
+	std::sort(n.begin(), n.end(), onkey(&std::pair<K,pointer>::first));
+
+	pointer* p = &next;
+	next = 0;
+	for(size_t i=0; i < n.size(); ++i) {
+	    *p = n[i].second;
+	    p = &(*p)->sib;
+	}
+	*p = 0;
+    }
+
+private:
+    static pointer load(const pointer& p)
+    {
+	return __atomic_load_n(&p, __ATOMIC_ACQUIRE);
+    }
+
+    static bool marked(pointer p)
+    {
+	return reinterpret_cast<uintptr_t>(p) & 1;
+    }
+
+    // the node a link points to, frozen or not
+    static pointer child(const pointer& p)
+    {
+	return reinterpret_cast<pointer>(reinterpret_cast<uintptr_t>(load(p)) & ~uintptr_t(1));
+    }
+
+    static bool frozen(pointer p)
+    {
+	return marked(load(p->next)) || marked(load(p->sib));
+    }
+
+    static void mark(pointer& link)
+    {
+	pointer v = load(link);
+	while(!marked(v))
+	    if(__atomic_compare_exchange_n(&link, &v, reinterpret_cast<pointer>(reinterpret_cast<uintptr_t>(v) | 1), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		break;
+    }
+
+    // freeze p, and make an unfrozen copy of it
+    static pointer copy(pointer p)
+    {
+	mark(p->next);
+	mark(p->sib);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	pointer const c = new T(*p);
+	c->next = child(p->next);
+	c->sib = child(p->sib);
+	return c;
+    }
+
+    // put c in the place of p; fails if p was replaced already, or the link to it is frozen
+    bool replace(pointer p, pointer c)
+    {
+	pointer* link = &next;
+	for(pointer q; (q = child(*link)) != p; link = &q->sib)
+	    if(!q) return false;
+	pointer expected = p;
+	return __atomic_compare_exchange_n(link, &expected, c, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+
+    // a subtree that was never published
+    static void discard(pointer n)
+    {
+	for(pointer p = n->next, q; p; p = q) {
+	    q = p->sib;
+	    discard(p);
+	}
+	delete n;
+    }
+
+    /* the key of p matches str from ofs up to end: put a node for that part
+       in the place of p, with a copy of p and the rest of str below it */
+    template<class S>
+    T* split(pointer p, S str, size_t ofs, size_t end)
+    {
+	pointer const c = copy(p);
+	std::string label;
+	key_traits<K>::append(label, c->key);
+	size_t i = end-ofs;
+	c->key = key_traits<K>::extract_key(label.c_str(), i);
+	label.resize(end-ofs);
+	i = 0;
+
+	pointer m;
+	T* const rn = &T::create(m, str, end);
+	m->key = key_traits<K>::extract_key(label.c_str(), i);
+	m->sib = c->sib;
+	c->sib = m->next;
+	m->next = c;
+	if(replace(p, m))
+	    return rn;
+
+	m->next = c->sib;
+	delete c;
+	discard(m);
+	return 0;
+    }
+};
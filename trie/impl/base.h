@@ -5,20 +5,118 @@
 #include <cstddef>
 #include <cstring>
 #include <string>
+#include <vector>
+#include <functional>
+#include "../../util/utf8.h"
+
+/* a key that is not NUL-terminated, e.g. a slice of a larger buffer;
+   reading past the end (or an embedded NUL) ends the key */
+
+struct char_view {
+    char_view(const char* data, size_t len) : data(data), len(len) { }
+    char operator[](size_t i) const  { return i < len? data[i] : '\0'; }
+    const char* data;
+    size_t len;
+};
+
+inline size_t key_length(const char* str, size_t ofs=0)
+{ return std::strlen(str+ofs); }
+
+inline size_t key_length(char_view str, size_t ofs=0)
+{ size_t i = ofs; while(i < str.len && str.data[i]) ++i; return i-ofs; }
+
+inline const char* key_data(const char* str, size_t ofs=0)
+{ return str+ofs; }
+
+inline const char* key_data(char_view str, size_t ofs=0)
+{ return str.data+ofs; }
+
+// a fresh NUL-terminated copy of the key from ofs onwards
+template<class S>
+inline char* key_copy(S str, size_t ofs, size_t len)
+{
+    char* const copy = new char[len+1];
+    std::memcpy(copy, key_data(str,ofs), len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/* the key text of a lexicon read back by serialize.cpp is one block, which
+   is deleted as a whole; all other text comes from key_copy(), and is
+   freed when a key is dropped. a block stays listed after it is deleted,
+   so text that is allocated there later is never freed. not for when
+   another thread is reading a lexicon back */
+
+struct text_blocks {
+    typedef std::vector< std::pair<const char*, const char*> > list;
+    static list& all() { static list blocks; return blocks; }
+};
+
+// whether key text was allocated by key_copy()
+inline bool owned_text(const char* p)
+{
+    if(!p || !*p) return false;
+    std::less<const char*> before;
+    const text_blocks::list& blocks = text_blocks::all();
+    for(size_t i=0; i < blocks.size(); ++i)
+	if(!before(p, blocks[i].first) && before(p, blocks[i].second)) return false;
+    return true;
+}
+
+inline void free_text(const char* p)
+{
+    if(owned_text(p)) delete[] p;
+}
+
+// the weights of optimize() when there is no profile (see profile.cpp)
+struct no_profile {
+    size_t operator()(const void*) const { return 0; }
+};
+
+/* find_node() of a const node; every link has a const find_node() and
+   explore() that write nothing, and never move a child to the front */
+template<class T, class S>
+const T* find_child(const T& node, S str, size_t& ofs)
+{
+    return node.find_node(str, ofs);
+}
+
+// what a lexicon needs done once it has been read back in (see critbit.cpp)
+template<class T>
+void unserialized(T&, const char* text, size_t bytes)
+{
+    text_blocks::all().push_back(std::make_pair(text, text+bytes));
+}
+
+// how optimize() gets the number of words below a child (see incremental.cpp)
+template<class T, class W>
+size_t optimize_subtree(T& node, const W& hits)
+{
+    return node.optimize(hits);
+}
 
 template<class Key> struct key_traits;
 template<> struct key_traits<char> {
     static size_t length(char)
     { return 1; }
 
-    static bool match_key(char key, const char* test, size_t& ofs)
+    template<class S>
+    static bool match_key(char key, S test, size_t& ofs)
     { return ++ofs, true; }
 
-    static char extract_key(const char* str, size_t& ofs)
+    template<class S>
+    static char extract_key(S str, size_t& ofs)
     { return str[ofs++]; }
 
-    template<class T>
-    static T* split_key(T*& node, char& key, size_t split_pos, const char* str, size_t ofs)
+    static void append(std::string& str, char key)
+    { str += key; }
+
+    // append tail to key, if it fits
+    static bool join(char&, char)
+    { return false; }
+
+    template<class T, class S>
+    static T* split_key(T*& node, char& key, size_t split_pos, S str, size_t ofs)
     //static char split_key(char key, size_t i)
     { assert(!"key_traits<char>::split_key called."); }
 };
@@ -30,6 +128,17 @@ struct char_ptr {
     char* data;
 };
 
+// a key that is no longer in a trie
+inline void free_key(char_ptr key)
+{
+    free_text(key.data);
+}
+
+template<class K>
+inline void free_key(const K&)
+{
+}
+
 template<size_t N>
 struct char_store {
     char_store() : data()            { }
@@ -39,12 +148,72 @@ struct char_store {
 };
 
 typedef char_store<sizeof(void*)> char_word;
+typedef char_store<2> char_pair;  // see StrideVector
+
+/* one UTF-8 encoded character; links that find a child by the first byte
+   of its key cannot tell apart characters with the same lead byte, so use
+   this with StrideVector, which compares the whole symbol */
+
+struct utf8_char {
+    utf8_char() : data()             { }
+    operator char() const            { return *data; }
+    char& operator[](size_t i)       { return data[i]; }
+    char data[4];
+};
+
+template<> struct key_traits<utf8_char> {
+    static size_t length(utf8_char key)
+    { size_t i = 0; while(i < sizeof key.data && key.data[i]) ++i; return i; }
+
+    template<class S>
+    static bool match_key(utf8_char key, S test, size_t& ofs)
+    {
+	++ofs;
+	for(unsigned i=1; i < sizeof key.data && key[i]; ++i, ++ofs) {
+	    if(test[ofs] != key[i]) return false;
+	}
+	return true;
+    }
+
+    template<class S>
+    static utf8_char extract_key(S str, size_t& ofs)
+    {
+	utf8_char tmp;
+	unsigned const n = utf8::sequence_length(tmp[0] = str[ofs++]);
+	for(unsigned i=1; i < n && utf8::continuation(str[ofs]); ++i)
+	    tmp[i] = str[ofs++];
+	return tmp;
+    }
+
+    static void append(std::string& str, utf8_char key)
+    { str.append(key.data, length(key)); }
+
+    static unsigned symbol(utf8_char key)
+    {
+	unsigned sym = 0;
+	for(unsigned i=0; i < sizeof key.data; ++i)
+	    sym = sym << 8 | key.data[i] & 0xFF;
+	return sym;
+    }
+
+    template<class S>
+    static unsigned symbol(S str, size_t& ofs)
+    { return symbol(extract_key(str, ofs)); }
+
+    static bool join(utf8_char&, utf8_char)
+    { return false; }
+
+    template<class T, class S>
+    static T* split_key(T*& node, utf8_char& key, size_t split_pos, S str, size_t ofs)
+    { assert(!"key_traits<utf8_char>::split_key called."); }
+};
 
 template<> struct key_traits<char_ptr> {
     static size_t length(char_ptr key)
     { return std::strlen(key.data); }
 
-    static bool match_key(char_ptr key, const char* test, size_t& ofs)
+    template<class S>
+    static bool match_key(char_ptr key, S test, size_t& ofs)
     { 
 	size_t const base = ofs;
 	do { 
@@ -54,17 +223,31 @@ template<> struct key_traits<char_ptr> {
 	return false;
     }
 
-    static char_ptr extract_key(const char* str, size_t& ofs)
+    template<class S>
+    static char_ptr extract_key(S str, size_t& ofs)
     { 
-	str += ofs;
-	size_t const len = std::strlen(str);
+	size_t const len = key_length(str, ofs);
 	ofs += len;
-	return *str? std::strcpy(new char[len+1], str) : const_cast<char*>("");
+	return len? key_copy(str, ofs-len, len) : const_cast<char*>("");
+    }
+
+    static void append(std::string& str, char_ptr key)
+    { str += key.data; }
+
+    // tail is used up
+    static bool join(char_ptr& key, char_ptr tail)
+    {
+	size_t const len = std::strlen(key.data);
+	char* const data = new char[len+std::strlen(tail.data)+1];
+	std::strcpy(std::strcpy(data, key.data)+len, tail.data);
+	free_key(key);
+	free_key(tail);
+	return key.data = data, true;
     }
 
     // not exception safe
-    template<class T>
-    static T* split_key(T*& node, char_ptr& key, size_t split_pos, const char* str, size_t ofs)
+    template<class T, class S>
+    static T* split_key(T*& node, char_ptr& key, size_t split_pos, S str, size_t ofs)
     { 
 	char_ptr subkey = std::strcpy(new char[std::strlen(&key[split_pos])+1], &key[split_pos]);
         char_ptr newkey = extract_key(str, ofs);
@@ -88,7 +271,8 @@ public:
     static size_t length(char_word key)
     { size_t i = 0; while(i < sizeof key.data && key.data[i]) ++i; return i; }
 
-    static bool match_key(char_word key, const char* test, size_t& ofs)
+    template<class S>
+    static bool match_key(char_word key, S test, size_t& ofs)
     { 
 	++ofs;
 	for(unsigned i=1; i < sizeof key.data && key[i]; ++i, ++ofs) {
@@ -97,7 +281,8 @@ public:
 	return true;
     }
 
-    static char_word extract_key(const char* str, size_t& ofs)
+    template<class S>
+    static char_word extract_key(S str, size_t& ofs)
     { 
 	char_word tmp;
 	for(unsigned i=0; i < sizeof tmp.data; ++i, ++ofs)
@@ -105,9 +290,34 @@ public:
 	return tmp;
     }
 
+    static void append(std::string& str, char_word key)
+    { str.append(key.data, length(key)); }
+
+    // the key as a number that sorts like its text (for N <= 4, see StrideVector)
+    static unsigned symbol(char_word key)
+    {
+	unsigned sym = 0;
+	for(unsigned i=0; i < sizeof key.data; ++i)
+	    sym = sym << 8 | key.data[i] & 0xFF;
+	return sym;
+    }
+
+    template<class S>
+    static unsigned symbol(S str, size_t& ofs)
+    { return symbol(extract_key(str, ofs)); }
+
+    static bool join(char_word& key, char_word tail)
+    {
+	size_t const len = length(key), n = length(tail);
+	if(len+n > sizeof key.data) return false;
+	std::memcpy(key.data+len, tail.data, n);
+	if(len+n < sizeof key.data) key.data[len+n] = '\0';
+	return true;
+    }
+
     // not exception safe
-    template<class T>
-    static T* split_key(T*& node, char_word& key, const size_t split_pos, const char* str, size_t ofs)
+    template<class T, class S>
+    static T* split_key(T*& node, char_word& key, const size_t split_pos, S str, size_t ofs)
     { 
 	char_word subkey;
         char_word newkey = extract_key(str, ofs);
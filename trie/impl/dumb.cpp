@@ -21,9 +21,16 @@ struct Array<T,char> {
 
     Array() : tails() { }
 
-    pointer find_node(const char* str, size_t& ofs, bool opt=true)
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool opt=true)
     {
-	return str[ofs++&0xFF][tails];
+	return tails[str[ofs++]&0xFF];
+    }
+
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	return tails[str[ofs++]&0xFF];
     }
 
     void attach_node(char ch, pointer p)
@@ -31,7 +38,15 @@ struct Array<T,char> {
 	tails[ch&0xFF] = p;
     }
 
-    reference select_node(const char* str, size_t ofs=0)
+    std::pair<char,pointer> detach_node(char ch)
+    {
+	pointer const p = tails[ch&0xFF];
+	tails[ch&0xFF] = 0;
+	return std::make_pair(ch, p);
+    }
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
     {
 	if(pointer p = find_node(str,ofs)) 
 	    return p->insert(str,ofs);
@@ -76,12 +91,21 @@ struct Array<T,char> {
     template<class F>
     void explore(F fun, bool=0)
     {
-	for(char i=0; i < 256; i++) {
+	for(int i=0; i < 256; i++) {
 	    char c = i;
 	    if(tails[i]) fun(c, *tails[i]);
 	}
     }
 
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	for(int i=0; i < 256; i++) {
+	    char c = i;
+	    if(tails[i]) fun(c, static_cast<const T&>(*tails[i]));
+	}
+    }
+
     template<class F>
     void walk(F fun, const size_t lvl=0, char k=0) 
     {
@@ -111,9 +135,16 @@ struct Array1<T,char> {
 
     Array1() : tails() { }
 
-    pointer find_node(const char* str, size_t& ofs, bool opt=true)
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool opt=true)
     {
-	return str[ofs++&0xFF][tails];
+	return tails[str[ofs++]&0xFF];
+    }
+
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	return tails[str[ofs++]&0xFF];
     }
 
     void attach_node(char ch, pointer p)
@@ -121,7 +152,15 @@ struct Array1<T,char> {
 	tails[ch&0xFF] = p;
     }
 
-    reference select_node(const char* str, size_t ofs=0)
+    std::pair<char,pointer> detach_node(char ch)
+    {
+	pointer const p = tails[ch&0xFF];
+	tails[ch&0xFF] = 0;
+	return std::make_pair(ch, p);
+    }
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
     {
 	if(pointer p = find_node(str,ofs)) 
 	    return p->insert(str,ofs);
@@ -166,9 +205,18 @@ struct Array1<T,char> {
     template<class F>
     void explore(F fun, bool=0)
     {
-	for(char i=0; i < 256; i++) {
+	for(int i=0; i < 256; i++) {
+	    char c = i;
+	    if(tails[i]) fun(c, *tails[i]);
+	}
+    }
+
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	for(int i=0; i < 256; i++) {
 	    char c = i;
-	    fun(c, *tails[i]);
+	    if(tails[i]) fun(c, static_cast<const T&>(*tails[i]));
 	}
     }
 
@@ -0,0 +1,257 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include "base.h"
+#include "../../hash/fnv.h"
+
+/* Hashed: nodes have no child container at all; every edge of every node
+   of a given type lives in one open-addressing table, keyed by the id of
+   the parent and the character, as in the hashed tries of old. A node only
+   keeps its id, its number of edges and a 32-bit mask of the characters
+   (modulo 32) it has edges for, so most failing lookups never touch the
+   table, and the others cost one probe. The slot of an edge is the hash of
+   the id plus the character, so siblings mostly share cache lines.
+
+   explore() probes the characters that pass the mask, lower case letters
+   first, until it has seen all edges; the order is therefore arbitrary.
+   Ids are handed out on the first attach and not reused; nodes must not be
+   copied once they have children. Only char keys are supported. */
+
+template<class T, class K>
+struct Hashed;
+
+template<class T>
+struct Hashed<T,char> {
+    typedef Hashed link;
+    typedef T* pointer;
+    typedef T& reference;
+
+    struct entry {
+	uint32_t parent;
+	char key;
+	pointer child;
+    };
+
+    struct table_type {
+	std::vector<entry> slot;     // a power of two; child == 0 when free
+	size_t used;
+	uint32_t ids;
+
+	table_type() : used(), ids() { }
+
+	static size_t hash(uint32_t id)
+	{
+	    uint32_t h = 2166136261UL;
+	    for(int i=0; i < 4; ++i, id >>= 8)
+		h = fnv::hash32(h, char(id));
+	    return h;
+	}
+
+	// keep the edges of a node close together
+	static size_t hash(uint32_t id, char key)
+	{
+	    return hash(id) + (key&0xFF);
+	}
+
+	pointer find(uint32_t id, char key, size_t base) const
+	{
+	    size_t const mask = slot.size()-1;
+	    for(size_t i = base + (key&0xFF) & mask; const pointer p = slot[i].child; i = i+1 & mask)
+		if(slot[i].parent == id && slot[i].key == key) return p;
+	    return 0;
+	}
+
+	pointer find(uint32_t id, char key) const
+	{
+	    return find(id, key, hash(id));
+	}
+
+	void insert(uint32_t id, char key, pointer p)
+	{
+	    if(4*(used+1) > 3*slot.size()) grow();
+	    size_t const mask = slot.size()-1;
+	    size_t i = hash(id,key) & mask;
+	    for( ; slot[i].child; i = i+1 & mask)
+		if(slot[i].parent == id && slot[i].key == key) break;
+	    used += !slot[i].child;
+	    entry const e = { id, key, p };
+	    slot[i] = e;
+	}
+
+	pointer erase(uint32_t id, char key)
+	{
+	    size_t const mask = slot.size()-1;
+	    size_t i = hash(id,key) & mask;
+	    for( ; slot[i].child; i = i+1 & mask)
+		if(slot[i].parent == id && slot[i].key == key) break;
+	    pointer const p = slot[i].child;
+	    if(!p) return 0;
+	    // shift back the entries that would no longer be reachable
+	    for(size_t j = i+1 & mask; slot[j].child; j = j+1 & mask) {
+		size_t const home = hash(slot[j].parent, slot[j].key) & mask;
+		if((j-home & mask) >= (j-i & mask))
+		    slot[i] = slot[j], i = j;
+	    }
+	    slot[i] = entry();
+	    --used;
+	    return p;
+	}
+
+	void grow()
+	{
+	    std::vector<entry> old(slot.empty()? 0x400 : 2*slot.size());
+	    old.swap(slot);
+	    used = 0;
+	    for(size_t i=0; i < old.size(); ++i)
+		if(old[i].child) insert(old[i].parent, old[i].key, old[i].child);
+	}
+    };
+
+    static table_type table;
+
+    uint32_t id;
+    uint32_t keys;       // bit c%32 is set if there may be an edge for c
+    unsigned short edges;
+
+    Hashed() : id(), keys(), edges() { }
+
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool opt=true)
+    {
+	char const c = str[ofs++];
+	return keys >> (c&31) & 1? table.find(id, c) : 0;
+    }
+
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	char const c = str[ofs++];
+	return keys >> (c&31) & 1? table.find(id, c) : 0;
+    }
+
+    void attach_node(char ch, pointer p)
+    {
+	if(!id) id = ++table.ids;
+	edges += !child(ch);
+	table.insert(id, ch, p);
+	keys |= 1UL << (ch&31);
+    }
+
+    std::pair<char,pointer> detach_node(char ch)
+    {
+	pointer const p = keys >> (ch&31) & 1? table.erase(id, ch) : 0;
+	if(p) {
+	    --edges;
+	    if(!alias(ch)) keys &= ~(1UL << (ch&31));
+	}
+	return std::make_pair(ch, p);
+    }
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
+    {
+	if(pointer p = find_node(str,ofs))
+	    return p->insert(str,ofs);
+	else {
+	    reference rn = T::create(p,str,ofs);
+	    attach_node(str[ofs-1], p);
+	    return rn;
+	}
+    }
+
+    void reserve(size_t) const { }
+
+    size_t arity() const
+    {
+	return edges;
+    }
+
+    bool empty() const
+    {
+	return !edges;
+    }
+
+    /* utilities */
+    T* this_T()
+    {
+	return static_cast<T*>(this);
+    }
+
+    template<class F>
+    void explore(F fun, bool=0)
+    {
+	size_t n = edges;
+	size_t const base = table_type::hash(id);
+	for(int r = 0; n && r < 8; ++r)
+	    for(int i = 0; n && i < 32; ++i) {
+		char c = i | row[r];
+		if(keys >> i & 1)
+		    if(pointer p = table.find(id, c, base)) fun(c, *p), --n;
+	    }
+    }
+
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	size_t n = edges;
+	size_t const base = table_type::hash(id);
+	for(int r = 0; n && r < 8; ++r)
+	    for(int i = 0; n && i < 32; ++i) {
+		char c = i | row[r];
+		if(keys >> i & 1)
+		    if(const T* p = table.find(id, c, base)) fun(c, *p), --n;
+	    }
+    }
+
+    template<class F>
+    void walk(F fun, const size_t lvl=0, char k=0)
+    {
+	if(fun(k,*this_T(),lvl)) {
+	    walker<F> rec = { fun, lvl+1 };
+	    explore<walker<F>&>(rec);
+	}
+    }
+
+    size_t optimize()
+    {
+	size_t acc = !!this_T()->search_key;
+	optimizer rec = { &acc };
+	explore(rec);
+	return acc;
+    }
+
+private:
+    static const char row[8];
+
+    template<class F>
+    struct walker {
+	F fun;
+	size_t lvl;
+	void operator()(char c, T& child) { child.template walk<F>(fun,lvl,c); }
+    };
+
+    struct optimizer {
+	size_t* acc;
+	void operator()(char, T& child) const { *acc += child.optimize(); }
+    };
+
+    pointer child(char c) const
+    {
+	return keys >> (c&31) & 1? table.find(id, c) : 0;
+    }
+
+    // is there another edge that shares the bit of ch?
+    bool alias(char ch) const
+    {
+	for(int i = ch&31; i < 256; i += 32)
+	    if(char(i) != ch && table.find(id, i)) return true;
+	return false;
+    }
+};
+
+template<class T>
+typename Hashed<T,char>::table_type Hashed<T,char>::table;
+
+template<class T>
+const char Hashed<T,char>::row[8] = { 0x60, 0x40, 0x20, 0x00, char(0x80), char(0xA0), char(0xC0), char(0xE0) };
@@ -55,7 +55,8 @@ struct LinkedList {
     }
 #endif
 
-    pointer find_node(const char* str, size_t& ofs, bool opt=true)
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool opt=true)
     {
 	pointer p = seek_node(str[ofs], opt);
 	if(p && key_traits<K>::match_key(p->key, str, ofs))
@@ -64,6 +65,15 @@ struct LinkedList {
 	    return 0;
     }
 
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	for(const T* p = next; p; p = p->sib)
+	    if(p->key == str[ofs])
+		return key_traits<K>::match_key(p->key, str, ofs)? p : 0;
+	return 0;
+    }
+
     void attach_node(K k, pointer p)
     {
 	p->key = k;
@@ -71,7 +81,17 @@ struct LinkedList {
 	next = p;
     }
 
-    reference select_node(const char* str, size_t ofs=0)
+    std::pair<K,pointer> detach_node(char ch)
+    {
+	pointer& p = seek_node(ch, false);
+	pointer const q = p;
+	if(!q) return std::make_pair(K(), pointer());
+	p = q->sib;
+	return std::make_pair(q->key, q);
+    }
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
     {
 	const size_t begin_ofs = ofs;
 	pointer& p = seek_node(str[ofs]);
@@ -124,28 +144,42 @@ struct LinkedList {
 	    fun(p->key, *p);
     }
 
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	for(const T* p = next; p; p=p->sib)
+	    fun(p->key, *p);
+    }
+
 
     template<class F>
     void walk(F fun, const size_t ofs=0) 
     {
 	if(fun(key,*this_T(),ofs))
 	    for(pointer p = next; p; p=p->sib) 
-		p->walk<F>(fun,ofs+1);
+		p->template walk<F>(fun,ofs+1);
     }
 
     size_t optimize()
     {
-	std::vector<std::pair<size_t, pointer> > n;
+	return optimize(no_profile());
+    }
+
+    // order by the visits counted in a profile, and then by size
+    template<class W>
+    size_t optimize(const W& hits)
+    {
+	typedef std::pair<size_t,size_t> rank;
+	std::vector<std::pair<rank, pointer> > n;
 	size_t acc = !!this_T()->search_key;
 
 	for(pointer p = next; p; p=p->sib) {
-	    size_t card = p->optimize();
-	    n.push_back(std::make_pair(card,p));
+	    size_t card = optimize_subtree(*p, hits);
+	    n.push_back(std::make_pair(rank(hits(p),card),p));
 	    acc += card;
 	}
 
-	std::sort(n.begin(), n.end(), onkey(&std::pair<size_t,pointer>::first));
-	std::reverse(n.begin(), n.end());
+	std::sort(n.begin(), n.end(), onkey(&std::pair<rank,pointer>::first));
 
 	next = 0;
 	for(size_t i=0; i < n.size(); ++i) {
@@ -0,0 +1,235 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include "base.h"
+#include "../../util/containers.h"
+#include "../../util/rcu.h"
+
+/* RCUVector: a vector of children that is never changed in place, so one
+   thread can insert while others search the same trie without locks. The
+   children of a node are an immutable block; attaching, detaching or
+   splitting an edge, and optimize(), build a new block off to the side,
+   which is swapped in with a single atomic store, and the old one is
+   retired to util/rcu.h. New nodes are complete before they are
+   published, so a reader sees every word either fully or not at all.
+
+   The writer must be the only one to change the trie; readers need an
+   rcu::read_lock around every search, and must not keep nodes after it.
+   Words are published, values are not: a value assigned after the insert
+   is seen whenever it is seen. erase() deletes nodes at once, and is only
+   safe without readers. Children are scanned in order, as in Vector, but
+   there is no move-to-front. The text of a char_ptr key that is split is
+   retired with the block, unless it is part of an unserialized one. */
+
+template<class T, class K>
+struct RCUVector {
+    typedef RCUVector link;
+    typedef T* pointer;
+    typedef T& reference;
+    typedef std::pair<K,T*> value_type;
+
+    struct block {
+	size_t size;
+	value_type item[1];
+    };
+
+    block* tails;     // 0 if there are no children
+
+    RCUVector() : tails() { }
+    ~RCUVector() { ::operator delete(tails); }
+
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool=false)
+    {
+	if(const block* b = rcu::load(tails))
+	    for(size_t i=0; i < b->size; ++i)
+		if(b->item[i].first == str[ofs])
+		    return key_traits<K>::match_key(b->item[i].first, str, ofs)? b->item[i].second : 0;
+	return 0;
+    }
+
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	if(const block* b = rcu::load(tails))
+	    for(size_t i=0; i < b->size; ++i)
+		if(b->item[i].first == str[ofs])
+		    return key_traits<K>::match_key(b->item[i].first, str, ofs)? b->item[i].second : 0;
+	return 0;
+    }
+
+    void attach_node(K ch, pointer p)
+    {
+	block* const nb = copy(tails, 1);
+	nb->item[nb->size++] = value_type(ch,p);
+	publish(nb);
+    }
+
+    std::pair<K,pointer> detach_node(char ch)
+    {
+	for(size_t i=0; tails && i < tails->size; ++i)
+	    if(tails->item[i].first == ch) {
+		value_type const v = tails->item[i];
+		block* const nb = copy(tails, 0);
+		nb->size--;
+		std::memmove(nb->item+i, nb->item+i+1, (nb->size-i)*sizeof(value_type));
+		publish(nb);
+		return v;
+	    }
+	return std::make_pair(K(), pointer());
+    }
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
+    {
+	const size_t begin_ofs = ofs;
+	size_t i = 0;
+	while(tails && i < tails->size && tails->item[i].first != str[ofs]) ++i;
+	if(!tails || i == tails->size) {
+	    K ch = key_traits<K>::extract_key(str,ofs);
+	    pointer ptr;
+	    reference rn = T::create(ptr,str,ofs);
+	    attach_node(ch, ptr);
+	    return rn;
+	} else if(key_traits<K>::match_key(tails->item[i].first, str, ofs)) {
+	    return tails->item[i].second->insert(str,ofs);
+	} else {
+	    // split_key shortens the key in place, so give the copy a key of its own
+	    block* const nb = copy(tails, 0);
+	    value_type& e = nb->item[i];
+	    K const old = e.first;
+	    std::string label;
+	    key_traits<K>::append(label, e.first);
+	    size_t len = 0;
+	    e.first = key_traits<K>::extract_key(label.c_str(), len);
+	    reference rn = *key_traits<K>::split_key(e.second, e.first, ofs-begin_ofs, str, ofs);
+	    publish(nb);
+	    retire_key(old);
+	    return rn;
+	}
+    }
+
+    void reserve(size_t) const { }
+
+    size_t arity() const
+    {
+	const block* const b = rcu::load(tails);
+	return b? b->size : 0;
+    }
+
+    bool empty() const
+    {
+	return !arity();
+    }
+
+    size_t capacity() const
+    {
+	return arity();
+    }
+
+    std::pair<K,pointer> successor() const
+    {
+	return arity()==1? tails->item[0] : std::make_pair(K(),pointer());
+    }
+
+    /* utilities */
+    T* this_T()
+    {
+	return static_cast<T*>(this);
+    }
+
+    template<class F>
+    void explore(F fun, bool=0)
+    {
+	if(const block* b = rcu::load(tails))
+	    for(size_t i=0; i < b->size; ++i)
+		fun(b->item[i].first, *b->item[i].second);
+    }
+
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	if(const block* b = rcu::load(tails))
+	    for(size_t i=0; i < b->size; ++i)
+		fun(b->item[i].first, static_cast<const T&>(*b->item[i].second));
+    }
+
+    template<class F>
+    void walk(F fun, const size_t lvl=0, K k=K())
+    {
+	if(fun(k,*this_T(),lvl))
+	    if(const block* b = rcu::load(tails))
+		for(size_t i=0; i < b->size; ++i)
+		    b->item[i].second->template walk<F>(fun,lvl+1,b->item[i].first);
+    }
+
+    size_t optimize()
+    {
+	return optimize(no_profile());
+    }
+
+    // order by the visits counted in a profile, and then by size; blocks that are in order are kept
+    template<class W>
+    size_t optimize(const W& hits)
+    {
+	typedef std::pair<size_t,size_t> rank;
+	std::vector<std::pair<rank, size_t> > n;
+	size_t acc = !!this_T()->search_key;
+	const block* const b = tails;
+	if(!b) return acc;
+	n.reserve(b->size);
+
+	for(size_t i=0; i < b->size; ++i) {
+	    size_t card = optimize_subtree(*b->item[i].second, hits);
+	    n.push_back(std::make_pair(rank(hits(b->item[i].second),card),i));
+	    acc += card;
+	}
+
+	std::sort(n.begin(), n.end(), onkey(&std::pair<rank,size_t>::first, std::greater<rank>()));
+
+	size_t i = 0;
+	while(i < n.size() && n[i].second == i) ++i;
+	if(i < n.size()) {
+	    block* const nb = copy(b, 0);
+	    for(i=0; i < n.size(); ++i) nb->item[i] = b->item[n[i].second];
+	    publish(nb);
+	}
+	return acc;
+    }
+
+private:
+    // the children of b, with room for extra more
+    static block* copy(const block* b, size_t extra)
+    {
+	size_t const n = b? b->size : 0;
+	block* const nb = static_cast<block*>(::operator new(sizeof(block) + (n+extra)*sizeof(value_type)));
+	nb->size = n;
+	if(n) std::memcpy(nb->item, b->item, n*sizeof(value_type));
+	return nb;
+    }
+
+    void publish(block* nb)
+    {
+	block* const old = tails;
+	rcu::publish(tails, nb);
+	if(old) rcu::retire(old);
+    }
+
+    // the text of a key that readers may still be in
+    static void retire_key(char_ptr key)
+    {
+	if(owned_text(key.data)) rcu::retire_array(key.data);
+    }
+
+    template<class Key>
+    static void retire_key(const Key&)
+    {
+    }
+
+    RCUVector(const RCUVector&);
+};
@@ -20,7 +20,8 @@ struct BinaryTree {
 
     BinaryTree() : key(), next(), sib() { }
 
-    pointer find_node(const char* str, size_t& ofs, bool opt=true) 
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool opt=true) 
     {
 	const char ch = str[ofs];
 	pointer cur = next;
@@ -32,11 +33,25 @@ struct BinaryTree {
 	return 0;
     }
 
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	const char ch = str[ofs];
+	const T* cur = next;
+	while(cur) {
+	    if(cur->key == ch)
+		return key_traits<K>::match_key(cur->key, str, ofs)? cur : 0;
+	    cur = cur->sib[ch > cur->key];
+	}
+	return 0;
+    }
+
     // boilerplate class to avoid unncessary over-templatizing 
     struct args_base {
 	virtual void operator()(T*&) const = 0;
 	virtual operator T*()        const = 0;
     };
+    template<class S>
     struct args : args_base {
 	operator T*() const 
 	{ 
@@ -62,11 +77,11 @@ struct BinaryTree {
 	    node->T::link::operator=(link);
 	}
 
-	const char* const str;
+	S const str;
 	size_t const ofs;
 	mutable T* result;
 
-	args(const char* str, size_t ofs=0)
+	args(S str, size_t ofs=0)
 	: str(str), ofs(ofs) { }
     };
 
@@ -95,10 +110,33 @@ struct BinaryTree {
 	    insert_node(node->sib[ch > node->key], ch, payload);
     }
 
-    reference select_node(const char* str, size_t ofs=0)
+    // the siblings are simply reattached, so any balancing scheme stays intact
+    std::pair<K,pointer> detach_node(char ch)
+    {
+	std::vector<T*> rest;
+	explore_nodes<collect>(next, collect(rest), false);
+	next = 0;
+	T* found = 0;
+	for(size_t i=0; i < rest.size(); ++i)
+	    if(rest[i]->key == ch)
+		found = rest[i];
+	    else
+		this_T()->attach_node(rest[i]->key, rest[i]);
+	if(!found) return std::make_pair(K(), pointer());
+	return std::make_pair(found->key, found);
+    }
+
+    struct collect {
+	std::vector<T*>& nodes;
+	collect(std::vector<T*>& nodes) : nodes(nodes) { }
+	void operator()(K, T& node) const { nodes.push_back(&node); }
+    };
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
     {
 	// type prefix to enable us to 'override' this method in derived classes
-	args payload(str,ofs);
+	args<S> payload(str,ofs);
 	T::insert_node(next, str[ofs], payload);
 	return *payload.result;
     }
@@ -141,34 +179,53 @@ struct BinaryTree {
     }
 
 
-    template<class F>
-    static void explore_nodes(T* tree, F fun, bool in_order)
+    // N is T, or const T
+    template<class F, class N>
+    static void explore_nodes(N* tree, F fun, bool in_order)
     {
 	if(tree) {
 	    if(!in_order) fun(tree->key, *tree);
-	    explore_nodes<F>(tree->sib[0], fun, in_order);
+	    explore_nodes<F,N>(tree->sib[0], fun, in_order);
 	    if( in_order) fun(tree->key, *tree);
-	    explore_nodes<F>(tree->sib[1], fun, in_order);
+	    explore_nodes<F,N>(tree->sib[1], fun, in_order);
+	}
+    }
+
+    template<class F, class N>
+    static void explore_levels(N* root, F fun)
+    {
+	std::vector<N*> open;
+	if(root) open.push_back(root);
+	for(int i=0; i < open.size(); ++i) {
+	    N* const tree = open[i];
+	    fun(tree->key, *tree);
+	    if(tree->sib[0]) open.push_back(tree->sib[0]);
+	    if(tree->sib[1]) open.push_back(tree->sib[1]);
 	}
     }
 
     template<class F>
     void explore(F fun, bool in_order)
     {
-	explore_nodes<F>(next, fun, in_order);
+	explore_nodes<F,T>(next, fun, in_order);
+    }
+
+    template<class F>
+    void explore(F fun, bool in_order) const
+    {
+	explore_nodes<F,const T>(next, fun, in_order);
     }
 
     template<class F>
     void explore(F fun)
     {   
-	std::vector<T*> open;
-	if(next) open.push_back(next);
-	for(int i=0; i < open.size(); ++i) {
-	    T* const tree = open[i];
-	    fun(tree->key, *tree);
-	    if(tree->sib[0]) open.push_back(tree->sib[0]);
-	    if(tree->sib[1]) open.push_back(tree->sib[1]);
-	}
+	explore_levels<F,T>(next, fun);
+    } 
+
+    template<class F>
+    void explore(F fun) const
+    {   
+	explore_levels<F,const T>(next, fun);
     } 
 
     template<class F>
@@ -216,8 +273,10 @@ struct RotateTree : BinaryTree<T,K> {
     typedef RotateTree link;
 
     using BinaryTree<T,K>::rotate;
+    using BinaryTree<T,K>::find_node;
 
-    T* find_node(const char* str, size_t& ofs, bool opt=true)
+    template<class S>
+    T* find_node(S str, size_t& ofs, bool opt=true)
     {
 	if(T* cur = sift_up(BinaryTree<T,K>::next, str[ofs], opt)) {
 	    return key_traits<K>::match_key(cur->key, str, ofs)? cur : 0;
@@ -257,6 +316,7 @@ struct BinaryTreeOpt : BinaryTree<T,K> {
     typedef BinaryTreeOpt link;
 
     using BinaryTree<T,K>::rotate;
+    using BinaryTree<T,K>::find_node;
     using BinaryTree<T,K>::next;
     using BinaryTree<T,K>::sib;
 
@@ -278,7 +338,8 @@ struct BinaryTreeOpt : BinaryTree<T,K> {
         return *cur;
     }
 
-    T* find_node(const char* str, size_t& ofs, bool opt=true)
+    template<class S>
+    T* find_node(S str, size_t& ofs, bool opt=true)
     {
 	if(T* node = seek_node(str[ofs], opt)) 
 	    return key_traits<K>::match_key(node->key, str, ofs)? node : 0;
@@ -286,15 +347,16 @@ struct BinaryTreeOpt : BinaryTree<T,K> {
 	    return 0;
     }
 
-    T& select_node(const char* str, size_t ofs=0)
+    template<class S>
+    T& select_node(S str, size_t ofs=0)
     {
-	typename BinaryTree<T,K>::args payload(str,ofs);
+	typename BinaryTree<T,K>::template args<S> payload(str,ofs);
 	T*& node = seek_node(str[ofs]);
 	if(node)
 	    payload(node);
 	else 
 	    node = payload;
-	return payload.result;
+	return *payload.result;
     }
 };
 
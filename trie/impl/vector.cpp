@@ -16,10 +16,12 @@ struct Vector_base : protected tails {
 
     typedef typename tails::value_type value_type;
     typedef typename tails::iterator iterator;
+    typedef typename tails::const_iterator const_iterator;
 
     Vector_base() : tails() { }
 
-    pointer find_node(const char* str, size_t& ofs, bool opt=true)
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool opt=true)
     {
 	iterator p = seek_node(str[ofs],opt);
 	if(p != tails::end() && key_traits<K>::match_key(p->first, str, ofs))
@@ -28,6 +30,15 @@ struct Vector_base : protected tails {
 	    return 0;
     }
 
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	for(const_iterator p = tails::begin(); p != tails::end(); ++p)
+	    if(p->first == str[ofs])
+		return key_traits<K>::match_key(p->first, str, ofs)? p->second : 0;
+	return 0;
+    }
+
     iterator seek_node(const char k, bool opt=true) 
     {
         for(iterator p = tails::begin(); p != tails::end(); ++p) 
@@ -48,7 +59,17 @@ struct Vector_base : protected tails {
 	tails::push_back(value_type(ch,p));
     }
 
-    reference select_node(const char* str, size_t ofs=0)
+    std::pair<K,pointer> detach_node(char ch)
+    {
+	iterator p = seek_node(ch, false);
+	if(p == tails::end()) return std::make_pair(K(), pointer());
+	value_type const v = *p;
+	tails::erase(p);
+	return std::make_pair(K(v.first), v.second);
+    }
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
     {
 //if(ofs==0) puts(str);
 	const size_t begin_ofs = ofs;
@@ -96,6 +117,13 @@ struct Vector_base : protected tails {
 	    fun(p->first, *p->second);
     }
 
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	for(const_iterator p = tails::begin(); p != tails::end(); ++p)
+	    fun(p->first, static_cast<const T&>(*p->second));
+    }
+
     template<class F>
     void walk(F fun, const size_t lvl=0, K k=K()) 
     {
@@ -106,17 +134,25 @@ struct Vector_base : protected tails {
 
     size_t optimize()
     {
-	std::vector<std::pair<size_t, value_type> > n;
+	return optimize(no_profile());
+    }
+
+    // order by the visits counted in a profile, and then by size
+    template<class W>
+    size_t optimize(const W& hits)
+    {
+	typedef std::pair<size_t,size_t> rank;
+	std::vector<std::pair<rank, value_type> > n;
 	size_t acc = !!this_T()->search_key;
 	n.reserve(arity());
 
 	for(iterator p = tails::begin(); p != tails::end(); ++p) {
-	    size_t card = p->second->optimize();
-	    n.push_back(std::make_pair(card,*p));
+	    size_t card = optimize_subtree(*p->second, hits);
+	    n.push_back(std::make_pair(rank(hits(p->second),card),*p));
 	    acc += card;
 	}
 
-	std::sort(n.begin(), n.end(), onkey(&std::pair<size_t,value_type>::first, std::greater<size_t>()));
+	std::sort(n.begin(), n.end(), onkey(&std::pair<rank,value_type>::first, std::greater<rank>()));
 
 	for(size_t i=0; i < n.size(); ++i) (*this)[i] = n[i].second;
 	return acc;
@@ -142,19 +178,19 @@ template<class T, class K>
 struct SortedVector : Vector<T,K> {
     typedef SortedVector link;
     typedef typename Vector<T,K>::iterator iterator;
+    typedef typename Vector<T,K>::const_iterator const_iterator;
     typedef typename Vector<T,K>::pointer pointer;
     typedef typename Vector<T,K>::reference reference;
     typedef typename Vector<T,K>::value_type value_type;
 
-    bool index(char ch, iterator& pos)
+    template<class I>
+    static bool index(char ch, I begin, I end, I& pos)
     {
-	iterator begin = Vector<T,K>::begin();
-	iterator end   = Vector<T,K>::end();
 	if(begin != end) {
 volatile value_type _ = *begin;
 }
 	while(begin != end) {
-	    iterator const mid = begin+(end-begin)/2;
+	    I const mid = begin+(end-begin)/2;
 	    if(ch < mid->first) end = mid; else
 	    if(ch > mid->first) begin = mid+1; else
 	    return pos=mid, true;
@@ -162,7 +198,18 @@ volatile value_type _ = *begin;
 	return pos=begin, false;
     }
 
-    pointer find_node(const char* str, size_t& ofs, bool=false)
+    bool index(char ch, iterator& pos)
+    {
+	return index(ch, Vector<T,K>::begin(), Vector<T,K>::end(), pos);
+    }
+
+    bool index(char ch, const_iterator& pos) const
+    {
+	return index(ch, Vector<T,K>::begin(), Vector<T,K>::end(), pos);
+    }
+
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool=false)
     {
 	iterator pos;
 	if(index(str[ofs], pos) && key_traits<K>::match_key(pos->first, str, ofs))
@@ -171,6 +218,16 @@ volatile value_type _ = *begin;
 	    return 0;
     }
 
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	const_iterator pos;
+	if(index(str[ofs], pos) && key_traits<K>::match_key(pos->first, str, ofs))
+	    return pos->second;
+	else
+	    return 0;
+    }
+
     void attach_node(K ch, pointer p)
     {
 	iterator pos;
@@ -178,7 +235,8 @@ volatile value_type _ = *begin;
 	Vector<T,K>::insert(pos, value_type(ch,p));
     }
 
-    reference select_node(const char* str, size_t ofs=0)
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
     {
 	const size_t begin_ofs = ofs;
 	iterator pos;
@@ -199,6 +257,145 @@ private:
     void optimize();
 };
 
+//////////////////////////////////
+
+ /* two characters per edge (K = char_pair): the children of a node are
+    the continuations of two characters, sorted on their 16-bit symbol, so
+    a lookup takes one hop per pair. a word that ends one character into
+    a pair gets an edge of its own, sorted just before the pairs starting
+    with that character. the symbols come from key_traits<K>, so this also
+    takes one UTF-8 character per edge (K = utf8_char).
+
+    since siblings can share their first character, this does not work
+    with what steps through a trie one character at a time (cursor.cpp
+    and the modules built on it, merge.cpp, erase()) */
+
+template<class T, class K>
+struct StrideVector : private std::vector< std::pair<K,T*> > {
+    typedef StrideVector link;
+    typedef T* pointer;
+    typedef T& reference;
+    typedef std::vector< std::pair<K,T*> > tails;
+
+    typedef typename tails::value_type value_type;
+    typedef typename tails::iterator iterator;
+    typedef typename tails::const_iterator const_iterator;
+
+    StrideVector() : tails() { }
+
+    template<class I>
+    static bool index(unsigned sym, I begin, I end, I& pos)
+    {
+	while(begin != end) {
+	    I const mid = begin+(end-begin)/2;
+	    unsigned const cur = key_traits<K>::symbol(mid->first);
+	    if(sym < cur) end = mid; else
+	    if(sym > cur) begin = mid+1; else
+	    return pos=mid, true;
+	}
+	return pos=begin, false;
+    }
+
+    bool index(unsigned sym, iterator& pos)
+    {
+	return index(sym, tails::begin(), tails::end(), pos);
+    }
+
+    bool index(unsigned sym, const_iterator& pos) const
+    {
+	return index(sym, tails::begin(), tails::end(), pos);
+    }
+
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool=false)
+    {
+	size_t end = ofs;
+	iterator pos;
+	if(!index(key_traits<K>::symbol(str, end), pos))
+	    return 0;
+	ofs = end;
+	return pos->second;
+    }
+
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	size_t end = ofs;
+	const_iterator pos;
+	if(!index(key_traits<K>::symbol(str, end), pos))
+	    return 0;
+	ofs = end;
+	return pos->second;
+    }
+
+    void attach_node(K key, pointer p)
+    {
+	iterator pos;
+	index(key_traits<K>::symbol(key), pos);
+	tails::insert(pos, value_type(key,p));
+    }
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
+    {
+	iterator pos;
+	size_t end = ofs;
+	if(index(key_traits<K>::symbol(str, end), pos))
+	    return pos->second->insert(str, end);
+	K const key = key_traits<K>::extract_key(str, ofs);
+	pointer tmp;
+	reference rn = T::create(tmp,str,ofs);
+	tails::insert(pos, value_type(key,tmp));
+	return rn;
+    }
+
+    using tails::reserve;
+    using tails::empty;
+    using tails::capacity;
+
+    size_t arity() const
+    {
+	return tails::size();
+    }
+
+    /* utilities */
+    T* this_T() 
+    {
+	return static_cast<T*>(this);
+    }
+
+    // the children are always in order
+    template<class F>
+    void explore(F fun, bool=0)
+    {
+	for(iterator p = tails::begin(); p != tails::end(); ++p)
+	    fun(p->first, *p->second);
+    }
+
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	for(const_iterator p = tails::begin(); p != tails::end(); ++p)
+	    fun(p->first, static_cast<const T&>(*p->second));
+    }
+
+    template<class F>
+    void walk(F fun, const size_t lvl=0, K k=K()) 
+    {
+	if(fun(k,*this_T(),lvl))
+	    for(iterator p = tails::begin(); p != tails::end(); ++p)
+		p->second->template walk<F>(fun,lvl+1,p->first);
+    }
+
+    size_t optimize()
+    {
+	size_t acc = !!this_T()->search_key;
+	for(iterator p = tails::begin(); p != tails::end(); ++p)
+	    acc += p->second->optimize();
+	return acc;
+    }
+};
+
 //////////////////////////////////
 
 template<class T, class K>
@@ -212,10 +409,12 @@ struct IndirectVector : private std::vector<T*> {
 
     typedef typename std::vector<T*>::value_type value_type;
     typedef typename std::vector<T*>::iterator iterator;
+    typedef typename std::vector<T*>::const_iterator const_iterator;
 
     IndirectVector() : tails() { }
 
-    pointer find_node(const char* str, size_t& ofs, bool opt=true)
+    template<class S>
+    pointer find_node(S str, size_t& ofs, bool opt=true)
     {
 	iterator p = seek_node(str[ofs],opt);
 	if(p != tails::end() && key_traits<K>::match_key((*p)->key, str, ofs))
@@ -224,6 +423,15 @@ struct IndirectVector : private std::vector<T*> {
 	    return 0;
     }
 
+    template<class S>
+    const T* find_node(S str, size_t& ofs, bool=false) const
+    {
+	for(const_iterator p = tails::begin(); p != tails::end(); ++p)
+	    if((*p)->key == str[ofs])
+		return key_traits<K>::match_key((*p)->key, str, ofs)? *p : 0;
+	return 0;
+    }
+
     iterator seek_node(const char k, bool opt=true) 
     {
         for(iterator p = tails::begin(); p != tails::end(); ++p) 
@@ -245,7 +453,17 @@ struct IndirectVector : private std::vector<T*> {
 	tails::push_back(p);
     }
 
-    reference select_node(const char* str, size_t ofs=0)
+    std::pair<K,pointer> detach_node(char ch)
+    {
+	iterator p = seek_node(ch, false);
+	if(p == tails::end()) return std::make_pair(K(), pointer());
+	pointer const q = *p;
+	tails::erase(p);
+	return std::make_pair(q->key, q);
+    }
+
+    template<class S>
+    reference select_node(S str, size_t ofs=0)
     {
 //if(ofs==0) puts(str);
 	const size_t begin_ofs = ofs;
@@ -293,6 +511,13 @@ struct IndirectVector : private std::vector<T*> {
 	    fun((*p)->key, **p);
     }
 
+    template<class F>
+    void explore(F fun, bool=0) const
+    {
+	for(const_iterator p = tails::begin(); p != tails::end(); ++p)
+	    fun((*p)->key, static_cast<const T&>(**p));
+    }
+
     template<class F>
     void walk(F fun, const size_t lvl=0, K k=K()) 
     {
@@ -303,17 +528,25 @@ struct IndirectVector : private std::vector<T*> {
 
     size_t optimize()
     {
-	std::vector<std::pair<size_t, value_type> > n;
+	return optimize(no_profile());
+    }
+
+    // order by the visits counted in a profile, and then by size
+    template<class W>
+    size_t optimize(const W& hits)
+    {
+	typedef std::pair<size_t,size_t> rank;
+	std::vector<std::pair<rank, value_type> > n;
 	size_t acc = !!this_T()->search_key;
 	n.reserve(arity());
 
 	for(iterator p = tails::begin(); p != tails::end(); ++p) {
-	    size_t card = (*p)->optimize();
-	    n.push_back(std::make_pair(card,*p));
+	    size_t card = optimize_subtree(**p, hits);
+	    n.push_back(std::make_pair(rank(hits(*p),card),*p));
 	    acc += card;
 	}
 
-	std::sort(n.begin(), n.end(), onkey(&std::pair<size_t,value_type>::first, std::greater<size_t>()));
+	std::sort(n.begin(), n.end(), onkey(&std::pair<rank,value_type>::first, std::greater<rank>()));
 
 	for(size_t i=0; i < n.size(); ++i) (*this)[i] = n[i].second;
 	return acc;
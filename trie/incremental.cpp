@@ -0,0 +1,80 @@
+#pragma once
+
+#include "impl/base.h"
+#include "basis.cpp"
+
+/* re-optimizing only what has changed
+
+   use as incremental< simple_trie<tracked,Link,Key> >; every node keeps
+   the number of words below it as of the last optimize(), and a flag that
+   is set when a word is inserted or erased below it. optimize() only goes
+   into flagged subtrees and takes the cached counts of all the others, so
+   after a few inserts it sorts the nodes on the paths to the new words,
+   and nothing else. the result is the same as that of a full optimize().
+
+   nodes start out flagged, so the first optimize() does all the work.
+   after changing the trie in some other way (operator[] of the base, or
+   erasing through it), call touch() with the word.
+
+   only the links that sort by weight are supported: LinkedList, Vector,
+   CompactVector, SortedVector and IndirectVector; and only simple_trie<>,
+   since a trie<> moves words (with their info) from node to node. */
+
+struct tracked {
+    size_t words;   // in the subtree, as of the last optimize()
+    bool dirty;     // changed since then
+    tracked() : words(), dirty(true) { }
+};
+
+// the weights of a full optimize(), but clean subtrees are not entered
+struct dirty_only : no_profile { };
+
+template<class T>
+size_t optimize_subtree(T& node, const dirty_only& hits)
+{
+    if(node.info.dirty) {
+	node.info.words = node.optimize(hits);
+	node.info.dirty = false;
+    }
+    return node.info.words;
+}
+
+template<class Trie>
+struct incremental : Trie {
+    typedef typename Trie::trie_type node_type;
+
+    void optimize()
+    {
+	node_type& root = *this;
+	optimize_subtree(root, dirty_only());
+    }
+
+    template<class S>
+    node_type& insert(S str)
+    {
+	if(const node_type* found = Trie::search(str))
+	    return const_cast<node_type&>(*found);
+	node_type& leaf = Trie::insert(str);
+	touch(str);
+	return leaf;
+    }
+
+    template<class S>
+    bool erase(S str)
+    {
+	if(!Trie::erase(str))
+	    return false;
+	touch(str);
+	return true;
+    }
+
+    // flag the nodes on the path to str
+    template<class S>
+    void touch(S str)
+    {
+	node_type* cur = this;
+	size_t ofs = 0;
+	do cur->info.dirty = true;
+	while(str[ofs] && (cur = cur->find_node(str, ofs, false)));
+    }
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <string>
+#include "basis.cpp"
+
+ /* Merge the words of one lexicon into another by walking both tries in
+    step: a subtree that only exists in 'from' is moved over as a whole,
+    so the cost is proportional to the part of 'from' that overlaps with
+    'into'. Patricia edges are split where their labels diverge. When a
+    word is in both, fun(into_info, from_info) decides the value; the
+    default keeps the one in 'into'.
+
+    'from' is taken apart in the process and must not be used afterwards;
+    its nodes are not freed, since they may belong to an unserialized
+    block (see serialize.cpp).
+
+    This works on simple_trie<>; a trie<> keeps words in intermediate
+    nodes, where a moved subtree could duplicate them, so its words are
+    simply inserted one by one. */
+
+struct keep_value {
+    template<class T> void operator()(T&, const T&) const { }
+};
+
+template<class T, class F>
+void merge(T& into, T& from, F fun);
+
+template<class T>
+void merge(T& into, T& from)
+{
+    merge(into, from, keep_value());
+}
+
+namespace merge_impl {
+    template<class T, class F>
+    void join(value<T>& into, const value<T>& from, F& fun)
+    { fun(into.info, from.info); }
+
+    template<class F>
+    void join(value<void>&, const value<void>&, F&)
+    { }
+
+    template<class T>
+    struct step {
+	typedef typename T::key_type key_type;
+
+	static std::string spell(key_type key)
+	{
+	    std::string label;
+	    key_traits<key_type>::append(label, key);
+	    return label;
+	}
+
+	typedef std::vector< std::pair<key_type,T*> > list_type;
+
+	struct children {
+	    list_type* list;
+	    void operator()(key_type key, T& child) const
+	    { list->push_back(std::make_pair(key, &child)); }
+	};
+
+	struct finder {
+	    char c;
+	    T** found;
+	    key_type* key;
+	    void operator()(key_type k, T& child) const
+	    { if(!*found && char(k) == c) *found = &child, *key = k; }
+	};
+
+	// the child of a node whose edge starts with c
+	static T* child(T& node, char c, key_type& key)
+	{
+	    T* found = 0;
+	    finder fun = { c, &found, &key };
+	    node.explore(fun, false);
+	    return found;
+	}
+
+	// the list of children is shared by all levels and used as a stack
+	template<class F>
+	static void node(T& into, T& from, F& fun, list_type& list)
+	{
+	    if(from.search_key) {
+		if(into.search_key)
+		    join(into, from, fun);
+		else
+		    into.search_key = true, into.set(from);
+	    }
+	    size_t const base = list.size();
+	    children collect = { &list };
+	    from.explore(collect, false);
+	    for(size_t i=base; i < list.size(); ++i)
+		edge(into, spell(list[i].first), list[i].first, *list[i].second, fun, list);
+	    list.resize(base);
+	}
+
+	// merge the subtree 'from', reached by label, into the children of 'into'
+	template<class F>
+	static void edge(T& into, const std::string& label, key_type key, T& from, F& fun, list_type& list)
+	{
+	    size_t ofs = 0;
+	    if(T* const sub = into.find_node(label.c_str(), ofs, false)) {
+		// their edge is (a prefix of) ours
+		if(ofs == label.size())
+		    node(*sub, from, fun, list);
+		else {
+		    std::string const rest = label.substr(ofs);
+		    ofs = 0;
+		    edge(*sub, rest, key_traits<key_type>::extract_key(rest.c_str(), ofs), from, fun, list);
+		}
+		return;
+	    }
+
+	    key_type other;
+	    T* const sub = child(into, label[0], other);
+	    if(!sub)
+		return into.attach_node(key, &from);
+
+	    std::string const theirs = spell(other);
+	    size_t p = 1;
+	    while(p < label.size() && p < theirs.size() && label[p] == theirs[p]) ++p;
+
+	    // split their edge at p, by letting the link create the node for label[0..p)
+	    T& mid = into.link::select_node(label.substr(0, p).c_str(), 0);
+	    mid.search_key = false;
+	    if(p == label.size())
+		node(mid, from, fun, list);
+	    else {
+		std::string const rest = label.substr(p);
+		ofs = 0;
+		edge(mid, rest, key_traits<key_type>::extract_key(rest.c_str(), ofs), from, fun, list);
+	    }
+	}
+    };
+
+    template<class T, class F>
+    struct inserter {
+	T* into;
+	F* fun;
+	void operator()(const char* word, T& node) const
+	{
+	    if(const T* found = into->search(word))
+		join(const_cast<T&>(*found), node, *fun);
+	    else
+		into->insert(word).set(node);
+	}
+    };
+
+    template<class T, class F>
+    void words(T& into, T& from, F& fun, bool)
+    {
+	typename step<T>::list_type list;
+	step<T>::node(into, from, fun, list);
+    }
+
+    template<class T, class F>
+    void words(T& into, T& from, F& fun, const char*)
+    {
+	inserter<T,F> ins = { &into, &fun };
+	for_each_word(from, ins);
+    }
+}
+
+template<class T, class F>
+void merge(T& into, T& from, F fun)
+{
+    typedef typename T::trie_type trie_type;
+    trie_type& dst = into;
+    trie_type& src = from;
+    merge_impl::words(dst, src, fun, src.search_key);
+}
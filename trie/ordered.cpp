@@ -0,0 +1,236 @@
+#pragma once
+
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <string>
+
+#include "impl/base.h"
+#include "basis.cpp"
+#include "cursor.cpp"
+
+/* word counts per subtree: count_prefix, rank and select
+
+   use as ordered< simple_trie<counted,Link,Key> >; every node knows how
+   many words lie in its subtree (itself included), so the number of words
+   with a prefix, the position of a word in lexicographic order and the
+   n-th word can all be found in O(depth * arity) without walking the trie.
+
+   like in an FST, every node also stores the number of words in its
+   parent's subtree that come before it; summing these on the way down
+   gives each word a dense id (its rank) in O(depth), and word(id) turns
+   it back into a string.
+
+   insert() keeps the counts up to date; optimize() rebuilds them. they
+   are not serialized: call number() once after unserialize::read(), which
+   hands out the same ids as before since these only depend on the words.
+   only simple_trie<> is supported: a trie<> keeps words in intermediate
+   nodes, which breaks the order between a node and its children. */
+
+struct counted {
+    size_t words;    // in the subtree
+    size_t before;   // in the parent's subtree, before this one
+    counted() : words(), before() { }
+};
+
+template<class Trie>
+struct ordered : Trie {
+    typedef typename Trie::trie_type node_type;
+    typedef typename Trie::key_type key_type;
+
+    void optimize()
+    {
+	Trie::optimize();
+	number();
+    }
+
+    void number()
+    {
+	recount(*this);
+	this->info.before = 0;
+    }
+
+    template<class S>
+    node_type& insert(S str)
+    {
+	if(const node_type* found = Trie::search(str))
+	    return const_cast<node_type&>(*found);
+	node_type& leaf = Trie::insert(str);
+	// a split edge may have put new nodes on the path, so redo it bottom-up
+	std::vector<node_type*> path(1, this);
+	size_t i = 0;
+	while(node_type* next = str[i]? path.back()->find_node(str, i, false) : 0)
+	    path.push_back(next);
+	for( ; !path.empty(); path.pop_back()) {
+	    tally(*path.back());
+	    order(*path.back());
+	}
+	return leaf;
+    }
+
+    // search that also yields the id of the word
+    template<class S>
+    const node_type* search_id(S str, size_t& id)
+    {
+	node_type* cur = this;
+	size_t ofs = 0, acc = 0;
+	while(str[ofs]) {
+	    if(!(cur = cur->find_node(str, ofs, false)))
+		return 0;
+	    acc += cur->info.before;
+	}
+	return cur->search_key? (id = acc, cur) : 0;
+    }
+
+    // the word with the given id, or an empty string if there is none
+    std::string word(size_t id)
+    {
+	std::string str;
+	select(id, str);
+	return str;
+    }
+
+    size_t size() const
+    {
+	return this->info.words;
+    }
+
+    // number of words starting with prefix
+    template<class S>
+    size_t count_prefix(S prefix)
+    {
+	cursor<node_type> cur(this);
+	size_t len = 0;
+	while(prefix[len] && cur.step(prefix[len]))
+	    ++len;
+	const node_type* const top = prefix[len]? 0 : cur.subtree();
+	return top? top->info.words : 0;
+    }
+
+    // number of words that come before str in lexicographic order
+    template<class S>
+    size_t rank(S str)
+    {
+	node_type* cur = this;
+	size_t ofs = 0, res = 0;
+	std::string label;
+	while(str[ofs]) {
+	    res += !!cur->search_key;
+	    node_type* next = 0;
+	    below<S> fun = { &res, &label, &next, str, ofs };
+	    cur->explore(fun, false);
+	    if(!(cur = next)) break;
+	    ofs += label.size();
+	}
+	return res;
+    }
+
+    // the n-th word in lexicographic order (counting from 0), or 0 if there is none
+    const node_type* select(size_t n, std::string& word)
+    {
+	node_type* cur = this;
+	word.clear();
+	if(n >= cur->info.words)
+	    return 0;
+	while(!cur->search_key || n > 0) {
+	    node_type* next = 0;
+	    key_type key;
+	    locate fun = { n, &next, &key };
+	    cur->explore(fun, false);
+	    key_traits<key_type>::append(word, key);
+	    n -= next->info.before;
+	    cur = next;
+	}
+	return cur;
+    }
+
+private:
+    static std::string spell(key_type key)
+    {
+	std::string label;
+	key_traits<key_type>::append(label, key);
+	return label;
+    }
+
+    // add up the children that sort before str, and find the one it continues in
+    template<class S>
+    struct below {
+	size_t* res;
+	std::string* label;
+	node_type** next;
+	S str;
+	size_t ofs;
+	void operator()(key_type key, node_type& child) const
+	{
+	    std::string const lab = spell(key);
+	    size_t i = 0;
+	    while(i < lab.size() && lab[i] == str[ofs+i]) ++i;
+	    if(i == lab.size())
+		*next = &child, *label = lab;
+	    else if((unsigned char)lab[i] < (unsigned char)str[ofs+i])
+		*res += child.info.words;
+	}
+    };
+
+    // the child whose range of ids holds n
+    struct locate {
+	size_t n;
+	node_type** next;
+	key_type* key;
+	void operator()(key_type k, node_type& child) const
+	{
+	    if(child.info.before <= n && (!*next || (*next)->info.before < child.info.before))
+		*next = &child, *key = k;
+	}
+    };
+
+    struct children {
+	std::vector< std::pair<std::string,node_type*> >* sub;
+	void operator()(key_type key, node_type& child) const
+	{ sub->push_back(std::make_pair(spell(key), &child)); }
+    };
+
+    // recompute the offsets of the children of a node
+    static void order(node_type& node)
+    {
+	std::vector< std::pair<std::string,node_type*> > sub;
+	children fun = { &sub };
+	node.explore(fun, false);
+	std::sort(sub.begin(), sub.end());
+	size_t acc = !!node.search_key;
+	for(size_t i=0; i < sub.size(); ++i) {
+	    sub[i].second->info.before = acc;
+	    acc += sub[i].second->info.words;
+	}
+    }
+
+    struct summer {
+	size_t* acc;
+	void operator()(key_type, node_type& child) const
+	{ *acc += child.info.words; }
+    };
+
+    struct recounter {
+	size_t* acc;
+	void operator()(key_type, node_type& child) const
+	{ *acc += recount(child); }
+    };
+
+    // recompute the count of a node from those of its children
+    static void tally(node_type& node)
+    {
+	size_t acc = !!node.search_key;
+	summer fun = { &acc };
+	node.explore(fun, false);
+	node.info.words = acc;
+    }
+
+    static size_t recount(node_type& node)
+    {
+	size_t acc = !!node.search_key;
+	recounter fun = { &acc };
+	node.explore(fun, false);
+	order(node);
+	return node.info.words = acc;
+    }
+};
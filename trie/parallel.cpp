@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "impl/base.h"
+#include "basis.cpp"
+#include "../util/task_pool.h"
+
+/* optimize() on several threads:
+
+	parallel_optimize(*lexicon);
+
+   the trie is cut at the first level that has enough nodes to keep all
+   threads busy; the subtrees below it are independent, and are optimized
+   as separate tasks. the levels above are then done on this thread, using
+   the counts of the subtrees that were already done. the result is the
+   same as that of lexicon->optimize().
+
+   only the links that sort by weight are supported: LinkedList, Vector,
+   CompactVector, SortedVector and IndirectVector. link with -pthread. */
+
+namespace parallel_impl {
+    // the weights of a plain optimize(), with some subtrees counted already
+    struct presized : no_profile {
+	const std::map<const void*,size_t>* done;
+    };
+
+    template<class T>
+    size_t optimize_subtree(T& node, const presized& hits)
+    {
+	std::map<const void*,size_t>::const_iterator p = hits.done->find(&node);
+	return p != hits.done->end()? p->second : node.optimize(hits);
+    }
+
+    template<class T>
+    struct children {
+	std::vector<T*>* list;
+	void operator()(typename T::key_type, T& child) const { list->push_back(&child); }
+    };
+
+    template<class T>
+    struct optimizer {
+	std::vector<T*>* task;
+	std::vector<size_t>* card;
+	void operator()(size_t i) const { (*card)[i] = (*task)[i]->optimize(); }
+    };
+}
+
+template<class Trie>
+size_t parallel_optimize(Trie& lexicon, unsigned threads = task_pool::cores())
+{
+    typedef typename Trie::trie_type T;
+    T& root = lexicon;
+
+    // a few tasks per thread, since subtrees differ a lot in size
+    std::vector<T*> task(1, &root);
+    while(task.size() < 8*threads) {
+	std::vector<T*> below;
+	parallel_impl::children<T> fun = { &below };
+	for(size_t i=0; i < task.size(); ++i)
+	    task[i]->explore(fun, false);
+	if(below.empty()) break;
+	task.swap(below);
+    }
+
+    std::vector<size_t> card(task.size());
+    parallel_impl::optimizer<T> fun = { &task, &card };
+    task_pool::run(task.size(), fun, threads);
+
+    std::map<const void*,size_t> done;
+    for(size_t i=0; i < task.size(); ++i)
+	done[task[i]] = card[i];
+    parallel_impl::presized hits;
+    hits.done = &done;
+    return optimize_subtree(root, hits);
+}
@@ -0,0 +1,185 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include "basis.cpp"
+
+ /* Lazy enumeration of all words starting with a prefix, in lexicographic
+    order, e.g. for autocompletion:
+
+	prefix_range<Lexicon::trie_type> range(*lexicon, "foo");
+	for(prefix_range<...>::iterator p = range.begin(); p != range.end(); ++p)
+	    use(*p, p.node());
+
+    Nodes are only expanded when the iterator reaches them; the children
+    of each expanded node are sorted on the spot, since no link type keeps
+    them in order. Words that a trie<> stores in an intermediate node are
+    passed down to the child they belong under, so they come out in their
+    proper place. The current word is rebuilt in a buffer owned by the
+    iterator, and is only valid until it is advanced. */
+
+template<class T>
+struct prefix_range {
+    typedef typename T::key_type key_type;
+
+    class iterator {
+	struct item {
+	    std::string label;    // relative to the path of the frame
+	    T* node;
+	    bool word;            // a complete word, or a subtree
+
+	    bool operator<(const item& other) const
+	    { return label < other.label || label == other.label && !word && other.word; }
+	};
+
+	struct frame {
+	    size_t len;           // length of the path to this node
+	    size_t next;
+	    std::vector<item> items;
+	};
+
+	std::vector<frame> stack; // frames beyond 'top' are kept for reuse
+	size_t top;
+	std::string prefix;
+	std::string path;
+	std::string word;
+	const T* cur;
+
+    public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef std::string value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const std::string* pointer;
+	typedef const std::string& reference;
+
+	iterator() : top(0), cur(0) { }
+
+	iterator(T& root, const std::string& prefix)
+	: top(0), prefix(prefix), cur(0)
+	{
+	    expand(push(0), root, 0, 0);
+	    ++*this;
+	}
+
+	reference operator*() const  { return word; }
+	pointer operator->() const   { return &word; }
+
+	// the trie node that holds the current word
+	const T* node() const        { return cur; }
+
+	bool operator==(const iterator& other) const { return cur == other.cur; }
+	bool operator!=(const iterator& other) const { return cur != other.cur; }
+
+	iterator operator++(int)
+	{
+	    iterator tmp = *this;
+	    ++*this;
+	    return tmp;
+	}
+
+	iterator& operator++()
+	{
+	    while(top) {
+		size_t const f = top-1;
+		if(stack[f].next == stack[f].items.size()) {
+		    --top;
+		    continue;
+		}
+		item const it = stack[f].items[stack[f].next++];
+		path.resize(stack[f].len);
+		if(it.word) {
+		    word = path;
+		    word += it.label;
+		    cur = it.node;
+		    return *this;
+		}
+		// words that continue below this child are sorted right after it
+		size_t const first = stack[f].next;
+		size_t last = first;
+		while(last < stack[f].items.size() && stack[f].items[last].label.compare(0, it.label.size(), it.label) == 0)
+		    ++last;
+		stack[f].next = last;
+		path += it.label;
+		expand(push(path.size()), *it.node, first, last);
+	    }
+	    cur = 0;
+	    return *this;
+	}
+
+    private:
+	size_t push(size_t len)
+	{
+	    if(top == stack.size()) stack.push_back(frame());
+	    frame& f = stack[top];
+	    f.len = len;
+	    f.next = 0;
+	    f.items.clear();
+	    return top++;
+	}
+
+	struct collect {
+	    iterator* self;
+	    std::vector<item>* items;
+	    void operator()(key_type key, T& node) const
+	    {
+		item it = { std::string(), &node, false };
+		key_traits<key_type>::append(it.label, key);
+		self->add(*items, it);
+	    }
+	};
+
+	// fill a frame with the node's word and children, and the words passed down to it
+	void expand(size_t f, T& node, size_t first, size_t last)
+	{
+	    std::vector<item>& items = stack[f].items;
+	    size_t const skip = path.size() - stack[f-!!f].len;
+	    for(size_t i=first; i < last; ++i) {
+		item it = stack[f-1].items[i];
+		it.label.erase(0, skip);
+		add(items, it);
+	    }
+	    own_word(items, node, node.search_key);
+	    collect fun = { this, &items };
+	    node.explore(fun, false);
+	    std::sort(items.begin(), items.end());
+	}
+
+	void own_word(std::vector<item>& items, T& node, bool key)
+	{
+	    item it = { std::string(), &node, true };
+	    if(key) add(items, it);
+	}
+
+	void own_word(std::vector<item>& items, T& node, const char* key)
+	{
+	    item it = { std::string(key && T::full_key? key+path.size() : key? key : ""), &node, true };
+	    if(key) add(items, it);
+	}
+
+	// only keep what is compatible with the prefix
+	void add(std::vector<item>& items, const item& it)
+	{
+	    size_t const len = path.size();
+	    if(len < prefix.size()) {
+		size_t const n = std::min(it.label.size(), prefix.size()-len);
+		if(it.word && n < prefix.size()-len) return;
+		if(it.label.compare(0, n, prefix, len, n) != 0) return;
+	    }
+	    items.push_back(it);
+	}
+    };
+
+    template<class S>
+    prefix_range(T& dict, S prefix)
+    : dict(dict), prefix(key_data(prefix), key_length(prefix))
+    { }
+
+    iterator begin() const { return iterator(dict, prefix); }
+    iterator end() const   { return iterator(); }
+
+private:
+    T& dict;
+    std::string prefix;
+};
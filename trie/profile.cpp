@@ -0,0 +1,51 @@
+#pragma once
+
+#include <map>
+
+#include "impl/base.h"
+#include "basis.cpp"
+
+/* ordering children by observed traffic
+
+   optimize() puts the children with the most words below them first,
+   which is only a guess at how often they are visited. a profile counts
+   how often every node is entered by the exact lookups of a replay of
+   real queries, without changing the trie (nothing is moved to the front):
+
+	profile<Lexicon::trie_type> prof;
+	while(getline(queries, s)) prof.search(*lexicon, s.c_str());
+	lexicon->optimize(prof);
+
+   optimize(prof) then puts the most visited children first, and orders
+   the rest by size as before, so a trie that is only read from needs no
+   move-to-front. this matters to the links that are searched from the
+   front: LinkedList, Vector, CompactVector and IndirectVector. */
+
+template<class T>
+struct profile {
+    std::map<const T*, size_t> hits;
+
+    template<class S>
+    const T* search(T& root, S str)
+    {
+	T* cur = &root;
+	size_t ofs = 0;
+	do if(cur->search_key && cur->match_tail(str,ofs))
+	    return cur;
+	else if(cur = str[ofs]? cur->find_node(str,ofs,false) : 0)
+	    ++hits[cur];
+	while(cur);
+	return 0;
+    }
+
+    size_t operator()(const T* node) const
+    {
+	typename std::map<const T*, size_t>::const_iterator p = hits.find(node);
+	return p == hits.end()? 0 : p->second;
+    }
+
+    void clear()
+    {
+	hits.clear();
+    }
+};
@@ -6,10 +6,13 @@
 #include <ostream>
 #include <streambuf>
 #include "basis.cpp"
+#include "bloom.cpp"
 #include "impl/base.h"
 
 // TODO: safety in read (unchecked: can wander off...)
 
+// layout: nodes in preorder, [bloom filter], node count (8), char count (8)
+
 class serialize {
 
     enum cookie { var_len };
@@ -33,6 +36,8 @@ class serialize {
     template<class T>
     void out(T& lex);
 
+    void out(const bloom_filter& filter);
+
     size_t char_count, node_count;
     std::streambuf* const sb;
 
@@ -41,14 +46,16 @@ public:
     void operator()(typename T::key_type key, T& lex);
 
     template<class T>
-    static void write(std::ostream&, T*);
+    static void write(std::ostream&, T*, const bloom_filter* = 0);
 };
 
 template<class T>
-void serialize::write(std::ostream& out, T* lexicon)
+void serialize::write(std::ostream& out, T* lexicon, const bloom_filter* filter)
 {
     serialize writer(out.rdbuf());
     writer.out(*static_cast<T*>(lexicon));
+    if(filter && !filter->empty())
+	writer.out(*filter);
     writer.out(writer.node_count, 8);
     writer.out(writer.char_count, 8);
 }
@@ -138,6 +145,14 @@ void serialize::out(T& lex)
     lex.template explore<serialize&>(*this);
 }
 
+void serialize::out(const bloom_filter& filter)
+{
+    out(filter.k, var_len);
+    out(filter.bits.size(), var_len);
+    for(size_t i=0; i < filter.bits.size(); ++i)
+	out(filter.bits[i], 8);
+}
+
 class unserialize {
     std::streambuf* const sb;
 protected:
@@ -157,11 +172,15 @@ protected:
     template<class T>
     bool in(value<T>& data);
 
+    bool in(bloom_filter& filter);
+
     char* text;
 
 public:
+    /* lex is an array of nodes, and its keys are in a block of text of
+       their own; pass text to be able to delete[] both afterwards */
     template<class T>
-    static std::istream& read(std::istream& in, T*& lex);
+    static std::istream& read(std::istream& in, T*& lex, bloom_filter* = 0, char** text = 0);
 };
 
 template<class T>
@@ -177,24 +196,32 @@ class unserialize_t : unserialize {
 };
 
 template<class T>
-std::istream& unserialize::read(std::istream& in, T*& lex)
+std::istream& unserialize::read(std::istream& in, T*& lex, bloom_filter* filter, char** text)
 {
     char* text_buf = 0;
     T* node_buf = 0;
     try {
 	std::streambuf* sb = in.rdbuf();
 	unserialize_t<T> reader(sb);
-	sb->pubseekoff(-16,std::ios::end);
+	std::streampos const footer = sb->pubseekoff(-16,std::ios::end,std::ios::in);
 	size_t nodes, bytes;
 	bool ok = reader.in(nodes, 8) && reader.in(bytes, 8);
-	sb->pubseekoff(0,std::ios::beg);
+	sb->pubseekoff(0,std::ios::beg,std::ios::in);
 	if(!ok) 
 	    return in.setstate(std::istream::failbit), in;
 	reader.text = text_buf = new char[bytes];
 	reader.node = node_buf = new T[nodes];
 	//printf(">> %ld\n", (bytes + sizeof(T)*nodes) / 1024);
-	if(reader.in()) 
+	if(reader.in()) {
+	    bloom_filter none;
+	    if(sb->pubseekoff(0,std::ios::cur,std::ios::in) == footer)
+		;
+	    else if(!reader.in(filter? *filter : none))
+		return in.setstate(std::istream::failbit), in;
+	    if(text) *text = text_buf;
+	    unserialized(*node_buf, text_buf, bytes);
 	    return lex = node_buf, in;
+	}
 	in.setstate(std::istream::failbit);
     } catch(...) {
 	in.setstate(std::istream::badbit);
@@ -211,7 +238,7 @@ bool unserialize::in(size_t& value, int size)
 	return false;
     value = 0;
     for(int i=0; i < size; ++i)
-	value |= (data[i]&0xFF) << i*8;
+	value |= size_t(data[i]&0xFF) << i*8;
     //printf("[] Suc6 rd: 0x%x\n", int(value));
     return true;
 }
@@ -263,8 +290,10 @@ bool unserialize::in(const char*& str)
 	return false;
 #if SINGLE_STR
     static char tab[256][2];
-    if(!tab[255][0]) 
+    if(!tab[255][0]) {
 	for(int i=0; i < 256; ++i) tab[i][0] = i;
+	text_blocks::all().push_back(std::make_pair(tab[0], tab[0]+sizeof tab));
+    }
     if(len == 1) 
 	return str = tab[*text&0xFF], true;
 #endif
@@ -303,6 +332,21 @@ bool unserialize::in(value<T>& data)
 template<>
 bool unserialize::in(value<void>&) { return true; }
 
+bool unserialize::in(bloom_filter& filter)
+{
+    size_t k, words;
+    if(!in(k,var_len) || !in(words,var_len))
+	return false;
+    filter.k = k;
+    filter.bits.resize(words);
+    for(size_t i=0; i < words; ++i) {
+	size_t word;
+	if(!in(word, 8)) return false;
+	filter.bits[i] = word;
+    }
+    return true;
+}
+
 template<class T>
 bool unserialize_t<T>::in()
 {
@@ -0,0 +1,196 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <string>
+#include <algorithm>
+#include "basis.cpp"
+
+ /* Set operations on the words of two lexicons:
+
+	intersection(a, b, fun)          words in both
+	difference(a, b, fun)            words in a but not in b
+	symmetric_difference(a, b, fun)  words in exactly one of them
+
+    each calls fun(word) for the words in the result, in lexicographic
+    order; the versions without fun return them in a new lexicon.
+
+    The two tries are walked together, merging the children of each pair
+    of nodes in key order, so shared prefixes are visited only once and
+    subtrees that cannot contribute to the result are skipped. Patricia
+    edges need not line up; an edge that runs past a node in the other
+    trie is matched against that node's children.
+
+    This works on simple_trie<>; the words of a trie<> can sit at any
+    depth along their path, so there every word of one is looked up in
+    the other instead, and the words found are sorted before fun sees
+    them. */
+
+namespace set_ops {
+    enum { only_a = 1, only_b = 2, both = 4 };
+
+    template<class T, class F>
+    struct walker {
+	typedef typename T::key_type key_type;
+	typedef std::pair<std::string,T*> entry;
+	typedef std::vector<entry> list_type;
+
+	int const keep;
+	F& fun;
+	std::string path;
+	list_type list;  // children of all levels, used as a stack
+
+	walker(int keep, F& fun) : keep(keep), fun(fun) { }
+
+	struct children {
+	    list_type* list;
+	    void operator()(key_type key, T& child) const
+	    {
+		list->push_back(entry(std::string(), &child));
+		key_traits<key_type>::append(list->back().first, key);
+	    }
+	};
+
+	// the edges leaving a position: those of the node, or the rest of an edge
+	size_t push(T* node, const std::string& label)
+	{
+	    size_t const base = list.size();
+	    if(!node)
+		;
+	    else if(!label.empty())
+		list.push_back(entry(label, node));
+	    else {
+		children fun = { &list };
+		node->explore(fun, false);
+		std::sort(list.begin()+base, list.end());
+	    }
+	    return list.size();
+	}
+
+	// a position in both tries: on node a if la is empty, or before it on an edge
+	void visit(T* a, const std::string& la, T* b, const std::string& lb)
+	{
+	    bool const in_a = a && la.empty() && a->search_key;
+	    bool const in_b = b && lb.empty() && b->search_key;
+	    if(in_a && in_b? keep & both : in_a? keep & only_a : in_b && keep & only_b)
+		fun(path.c_str());
+
+	    size_t const base = list.size();
+	    size_t const mid  = push(a, la);
+	    size_t const end  = push(b, lb);
+	    for(size_t i = base, j = mid; i < mid || j < end; ) {
+		int const c1 = i < mid? (unsigned char)list[i].first[0] : 0x100;
+		int const c2 = j < end? (unsigned char)list[j].first[0] : 0x100;
+		entry const x = c1 <= c2? list[i++] : entry();
+		entry const y = c2 <= c1? list[j++] : entry();
+		descend(x.second, x.first, y.second, y.first);
+	    }
+	    list.resize(base);
+	}
+
+	// follow a pair of edges that start with the same character
+	void descend(T* a, const std::string& la, T* b, const std::string& lb)
+	{
+	    if(!b && !(keep & only_a) || !a && !(keep & only_b))
+		return;
+	    size_t p = 0;
+	    if(!a)
+		p = lb.size();
+	    else if(!b)
+		p = la.size();
+	    else {
+		while(p < la.size() && p < lb.size() && la[p] == lb[p]) ++p;
+		if(p < la.size() && p < lb.size()) {
+		    // the edges diverge: nothing in common below
+		    if((unsigned char)la[p] < (unsigned char)lb[p])
+			descend(a, la, 0, lb), descend(0, la, b, lb);
+		    else
+			descend(0, la, b, lb), descend(a, la, 0, lb);
+		    return;
+		}
+	    }
+	    size_t const len = path.size();
+	    path.append(a? la : lb, 0, p);
+	    visit(a, a? la.substr(p) : std::string(), b, b? lb.substr(p) : std::string());
+	    path.resize(len);
+	}
+    };
+
+    template<class T>
+    struct probe {
+	T* other;
+	std::vector<std::string>* found;
+	bool present;
+	void operator()(const char* word, T&) const
+	{
+	    if(!!other->search(word) == present) found->push_back(word);
+	}
+    };
+
+    template<class T, class F>
+    void apply(T& a, T& b, int keep, F& fun, bool)
+    {
+	walker<T,F> walk(keep, fun);
+	walk.visit(&a, std::string(), &b, std::string());
+    }
+
+    template<class T, class F>
+    void apply(T& a, T& b, int keep, F& fun, const char*)
+    {
+	std::vector<std::string> found;
+	probe<T> pa = { &b, &found, keep == both };
+	probe<T> pb = { &a, &found, false };
+	for_each_word(a, pa);
+	if(keep & only_b) for_each_word(b, pb);
+	std::sort(found.begin(), found.end());
+	for(size_t i=0; i < found.size(); ++i)
+	    fun(found[i].c_str());
+    }
+
+    template<class T, class F>
+    void apply(T& a, T& b, int keep, F& fun)
+    {
+	typedef typename T::trie_type trie_type;
+	trie_type& x = a;
+	trie_type& y = b;
+	apply(x, y, keep, fun, x.search_key);
+    }
+
+    template<class T>
+    struct collect {
+	T* lexicon;
+	void operator()(const char* word) const { lexicon->insert(word); }
+    };
+
+    template<class T>
+    T* build(T& a, T& b, int keep)
+    {
+	collect<T> fun = { new T };
+	apply(a, b, keep, fun);
+	return fun.lexicon;
+    }
+}
+
+template<class T, class F>
+void intersection(T& a, T& b, F fun)
+{ set_ops::apply(a, b, set_ops::both, fun); }
+
+template<class T, class F>
+void difference(T& a, T& b, F fun)
+{ set_ops::apply(a, b, set_ops::only_a, fun); }
+
+template<class T, class F>
+void symmetric_difference(T& a, T& b, F fun)
+{ set_ops::apply(a, b, set_ops::only_a|set_ops::only_b, fun); }
+
+template<class T>
+T* intersection(T& a, T& b)
+{ return set_ops::build(a, b, set_ops::both); }
+
+template<class T>
+T* difference(T& a, T& b)
+{ return set_ops::build(a, b, set_ops::only_a); }
+
+template<class T>
+T* symmetric_difference(T& a, T& b)
+{ return set_ops::build(a, b, set_ops::only_a|set_ops::only_b); }
@@ -1,8 +1,33 @@
 #pragma once
 #include <cstddef>
 #include <cassert>
+#include <vector>
+#include <queue>
+#include <utility>
+#include <string>
+#include "bloom.cpp"
+#include "exact_index.cpp"
 
- // speed up the first lookup in a trie by using an array
+ // speed up the first lookups in a trie by jumping over the top levels
+
+ /* The jump cache is a small radix tree of 256-entry tables; the first
+    table covers all 1-byte prefixes, and the hottest prefixes (the ones
+    with the most words below them) get a table for the next byte, up to
+    TURBO_DEPTH bytes and at most 'budget' tables in total. Every slot
+    holds the deepest trie node that can be reached on its prefix, so the
+    cache is read-only after freeze().
+
+    An optional Bloom filter is checked before anything else, so most
+    absent words never touch the trie; an optional exact_index then
+    answers the remaining lookups with a single hash probe. */
+
+#ifndef TURBO_DEPTH
+#define TURBO_DEPTH 3
+#endif
+
+#ifndef TURBO_BUDGET
+#define TURBO_BUDGET 64
+#endif
 
 template<class T>
 struct turbo {
@@ -11,37 +36,135 @@ struct turbo {
     typedef typename T::key_type key_type;
     typedef typename T::trie_type trie_type;
 
+    struct slot {
+	T* node;
+	unsigned short ofs;    // characters consumed to reach node
+	unsigned short depth;  // node hops saved
+	int sub;               // index of the table for the next byte, or -1
+    };
+
+    struct trace {
+	size_t skipped;        // node hops saved by the jump cache
+	bool filtered;         // rejected by the Bloom filter
+	bool indexed;          // answered by the exact index
+    };
+
     T* const dict;
-    T* lut[256];
+    bloom_filter* const filter;
+    exact_index<T>* const index;
+    std::vector<slot> tab;
+    size_t const budget;
 
-    turbo(T* dict) : dict(dict), lut() { }
+    turbo(T* dict, bloom_filter* filter = 0, exact_index<T>* index = 0, size_t budget = TURBO_BUDGET)
+    : dict(dict), filter(filter && !filter->empty()? filter : 0), index(index), budget(budget)
+    {
+	freeze();
+    }
 
     turbo* operator->() { return this; }
 
-    const T* search(const char* str)
+    template<class S>
+    const slot& jump(S str) const
     {
-	key_type(' ');
+	const slot* s = &tab[str[0]&0xFF];
+	for(size_t i = 1; s->sub >= 0 && str[i]; ++i)
+	    s = &tab[s->sub*256 + (str[i]&0xFF)];
+	return *s;
+    }
+
+    template<class S>
+    const T* search(S str) const
+    {
+	trace _;
+	return search(str, _);
+    }
+
+    template<class S>
+    const T* search(S str, trace& info) const
+    {
+	info.skipped = 0;
+	info.filtered = filter && !filter->contains(str);
+	if(info.filtered)
+	    return 0;
+	info.indexed = index != 0;
+	if(info.indexed)
+	    return index->search(str);
         if(dict->search_key && dict->match_tail(str,0))
             return dict;
-        else {
-	    if(T* entry = lut[*str&0xFF]) 
-		return entry->search(str, 1);
-	    else {
-		std::size_t ofs = 0;
-		if(T* entry = dict->find_node(str,ofs)) {
-		    if(sizeof(key_type)==1 || ofs==1)
-			lut[*str&0xFF] = entry;
-		    return entry->search(str, ofs);
-		}
-	    }
-	    return 0;
+	else if(tab.empty() || !str[0])
+	    return dict->search(str);
+	else {
+	    const slot& s = jump(str);
+	    info.skipped = s.depth;
+	    return s.node->search(str, s.ofs);
 	}
     }
 
-    T& insert(const char* str, const std::size_t ofs=0)
+    // the cache is dropped by insert(); call freeze() to rebuild it
+    template<class S>
+    T& insert(S str, const std::size_t ofs=0)
     {
-	T& result = dict.insert(str, ofs);
-	lut[*str & 0xFF] = 0;
-	return result;
+	if(filter) filter->insert(str);
+	tab.clear();
+	return index? index->insert(str, ofs) : dict->insert(str, ofs);
+    }
+
+    // drops the cache too; the Bloom filter keeps the word, which only costs a lookup
+    template<class S>
+    bool erase(S str)
+    {
+	tab.clear();
+	return index? index->erase(str) : dict->erase(str);
+    }
+
+    void freeze()
+    {
+	std::priority_queue< std::pair<size_t,size_t> > open;  // (words below, slot)
+	std::vector<std::string> prefix(1);
+
+	tab.clear();
+	fill(prefix[0], open);
+	while(tab.size()/256 < budget && !open.empty()) {
+	    size_t const i = open.top().second;
+	    open.pop();
+	    tab[i].sub = prefix.size();
+	    prefix.push_back(prefix[i/256] + char(i&0xFF));
+	    fill(prefix.back(), open);
+	}
+    }
+
+private:
+    static bool stops(bool)               { return false; }
+    static bool stops(const char* key)    { return key; }
+
+    struct counter {
+	size_t& n;
+	bool operator()(key_type, const T& node, size_t) const
+	{ return n += !!node.search_key, true; }
+    };
+
+    // add the table for all one-byte extensions of a prefix
+    void fill(std::string prefix, std::priority_queue< std::pair<size_t,size_t> >& open)
+    {
+	size_t const len = prefix.size()+1;
+	prefix += '\0';
+	for(int c = 0; c < 256; ++c) {
+	    prefix[len-1] = c;
+	    slot s = { dict, 0, 0, -1 };
+	    while(c && s.ofs < len) {
+		if(s.node != dict && stops(s.node->search_key)) break;
+		size_t ofs = s.ofs;
+		T* next = s.node->find_node(prefix.c_str(), ofs, false);
+		if(!next) break;
+		s.node = next, s.ofs = ofs, s.depth++;
+	    }
+	    if(s.ofs == len && len < TURBO_DEPTH && !s.node->empty()) {
+		size_t n = 0;
+		counter tally = { n };
+		s.node->walk(tally);
+		open.push(std::make_pair(n, tab.size()));
+	    }
+	    tab.push_back(s);
+	}
     }
 };
@@ -136,8 +136,30 @@ struct compact_association_vector {
 	{ return *p == *other.p; }
     };
 
+    struct const_iterator
+    {
+	const_iterator() : p(""), cont(0) { }
+	const_iterator(const compact_association_vector& cont) : cont(&cont), p(cont.keys) { }
+	const compact_association_vector* cont;
+	const char* p;
+	operator value_type() const 
+	{ return value_type(*p, cont->tails[p - cont->keys]); }
+	const_iterator& operator++() 
+	{ return ++p, *this; }
+	const const_iterator& operator*() const
+	{ return *this; }
+	proxy operator->() const
+	{ return proxy(*this); }
+	bool operator!=(const const_iterator& other) const
+	{ return *p != *other.p; }
+	bool operator==(const const_iterator& other) const
+	{ return *p == *other.p; }
+    };
+
     iterator begin() { return iterator(*this); }
     iterator end()   { return iterator(); }
+    const_iterator begin() const { return const_iterator(*this); }
+    const_iterator end()   const { return const_iterator(); }
 
     iterator operator[](size_t pos) 
     {
@@ -146,6 +168,16 @@ struct compact_association_vector {
 	return tmp;
     }
 
+    // the freed slot is left for push_back
+    void erase(const iterator& pos)
+    {
+	size_t const i = pos.p-keys;
+	std::memmove(keys+1,  keys,  i);
+	std::memmove(tails+1, tails, i*sizeof(T*));
+	*keys++ = 0;
+	++tails;
+    }
+
     void iter_swap(const iterator& p, const iterator& q)
     {
 	size_t const i = p.p-keys;
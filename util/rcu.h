@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/* publication and epoch based reclamation, for one writer and any number
+   of readers that take no locks (up to max_readers at a time):
+
+	rcu::reader me;                     // once per thread
+	{
+	    rcu::read_lock lock(me);        // not nested
+	    ... look at shared data ...
+	}
+
+   the writer makes changes on copies, swaps them in with publish(), and
+   hands what it replaced to retire() (or retire_array(), for what came
+   from new[]); that is freed by reclaim() once all readers that were
+   inside a read_lock when it was retired have left.
+   readers never wait. retire() reclaims every so often by itself.
+   uses the __atomic builtins of gcc and clang. */
+
+namespace rcu {
+
+enum { max_readers = 64 };
+
+// something retired, and how to free it
+struct garbage {
+    unsigned long epoch;
+    void* p;
+    void (*free)(void*);
+};
+
+struct domain {
+    unsigned long epoch;                  // 0 in a slot means idle
+    unsigned long slot[max_readers];      // the epoch its reader entered in
+    bool taken[max_readers];
+    std::vector<garbage> retired;         // the writer's
+
+    domain() : epoch(1), slot(), taken() { }
+};
+
+inline domain& global()
+{
+    static domain d;
+    return d;
+}
+
+// a reader slot; waits if they are all taken
+struct reader {
+    unsigned id;
+
+    reader() : id()
+    {
+	while(__atomic_test_and_set(&global().taken[id], __ATOMIC_ACQUIRE))
+	    id = (id+1) % max_readers;
+    }
+
+    ~reader()
+    {
+	__atomic_clear(&global().taken[id], __ATOMIC_RELEASE);
+    }
+private:
+    reader(const reader&);
+};
+
+struct read_lock {
+    unsigned long& slot;
+
+    read_lock(const reader& r) : slot(global().slot[r.id])
+    {
+	__atomic_store_n(&slot, __atomic_load_n(&global().epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+
+    ~read_lock()
+    {
+	__atomic_store_n(&slot, 0UL, __ATOMIC_RELEASE);
+    }
+};
+
+template<class T>
+T* load(T* const& p)
+{
+    return __atomic_load_n(&p, __ATOMIC_ACQUIRE);
+}
+
+// everything written before is seen by whoever loads the new value
+template<class T>
+void publish(T*& p, T* val)
+{
+    __atomic_store_n(&p, val, __ATOMIC_RELEASE);
+}
+
+// free what was retired before every reader that is still inside came in
+inline void reclaim()
+{
+    domain& d = global();
+    unsigned long const now = __atomic_add_fetch(&d.epoch, 1, __ATOMIC_SEQ_CST);
+    unsigned long oldest = now;
+    for(unsigned i=0; i < max_readers; ++i) {
+	unsigned long const e = __atomic_load_n(&d.slot[i], __ATOMIC_SEQ_CST);
+	if(e && e < oldest) oldest = e;
+    }
+    size_t keep = 0;
+    for(size_t i=0; i < d.retired.size(); ++i)
+	if(d.retired[i].epoch < oldest)
+	    d.retired[i].free(d.retired[i].p);
+	else
+	    d.retired[keep++] = d.retired[i];
+    d.retired.resize(keep);
+}
+
+inline void free_object(void* p)
+{
+    ::operator delete(p);
+}
+
+template<class T>
+void free_array(void* p)
+{
+    delete[] static_cast<T*>(p);
+}
+
+// p is no longer published; free(p) is called once no reader can see it
+inline void retire(void* p, void (*free)(void*))
+{
+    domain& d = global();
+    garbage const g = { __atomic_load_n(&d.epoch, __ATOMIC_RELAXED), p, free };
+    d.retired.push_back(g);
+    if(d.retired.size() >= 256)
+	reclaim();
+}
+
+// p was allocated with operator new
+inline void retire(void* p)
+{
+    retire(p, free_object);
+}
+
+// p was allocated with new[]
+template<class T>
+void retire_array(T* p)
+{
+    retire(p, free_array<T>);
+}
+
+}
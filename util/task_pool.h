@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <pthread.h>
+#include <unistd.h>
+
+// fork-join over a list of tasks; link with -pthread
+
+namespace task_pool {
+
+// the number of processors online
+inline unsigned cores()
+{
+    long const n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0? unsigned(n) : 1;
+}
+
+template<class F>
+struct job {
+    F* fun;
+    size_t count;
+    size_t next;     // the first task not yet taken
+
+    static void* work(void* arg)
+    {
+	job& self = *static_cast<job*>(arg);
+	for(size_t i; (i = __sync_fetch_and_add(&self.next, 1)) < self.count; )
+	    (*self.fun)(i);
+	return 0;
+    }
+};
+
+/* run fun(0) .. fun(n-1) on up to the given number of threads, which take
+   the next task as soon as they are done with one; the calling thread is
+   one of them. returns when all tasks are done */
+template<class F>
+void run(size_t n, F& fun, unsigned threads = cores())
+{
+    job<F> all = { &fun, n, 0 };
+    if(threads > n) threads = unsigned(n);
+    pthread_t* const tid = threads > 1? new pthread_t[threads-1] : 0;
+    unsigned started = 0;
+    while(started+1 < threads && pthread_create(&tid[started], 0, job<F>::work, &all) == 0)
+	++started;
+    job<F>::work(&all);
+    for(unsigned i=0; i < started; ++i)
+	pthread_join(tid[i], 0);
+    delete[] tid;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// decoding UTF-8; malformed input is not diagnosed, a stray byte simply counts as one character
+
+namespace utf8 {
+
+// the number of bytes in a sequence that starts with b
+inline unsigned sequence_length(char b)
+{
+    unsigned const c = b & 0xFF;
+    return c < 0xC0? 1 : c < 0xE0? 2 : c < 0xF0? 3 : 4;
+}
+
+inline bool continuation(char b)
+{
+    return (b & 0xC0) == 0x80;
+}
+
+// the length of the run of ASCII bytes at the start of str
+inline size_t ascii_prefix(const char* str, size_t len)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    for( ; i+16 <= len; i += 16) {
+	int const high = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(str+i)));
+	if(high) return i + __builtin_ctz(high);
+    }
+#else
+    for( ; i+8 <= len; i += 8) {
+	uint64_t word;
+	std::memcpy(&word, str+i, 8);
+	if(word & 0x8080808080808080ULL) break;
+    }
+#endif
+    while(i < len && !(str[i] & 0x80)) ++i;
+    return i;
+}
+
+// the codepoint at str[ofs]; ofs is moved past it, but never past len
+inline uint32_t decode(const char* str, size_t& ofs, size_t len)
+{
+    unsigned const n = sequence_length(str[ofs]);
+    uint32_t cp = str[ofs++] & (n == 1? 0xFF : 0x7F >> n);
+    for(unsigned i=1; i < n && ofs < len && continuation(str[ofs]); ++i)
+	cp = cp << 6 | str[ofs++] & 0x3F;
+    return cp;
+}
+
+// the number of characters in str
+inline size_t length(const char* str, size_t len)
+{
+    size_t n = 0, i = 0;
+    while(i < len) {
+	size_t const run = ascii_prefix(str+i, len-i);
+	n += run, i += run;
+	if(i < len) decode(str, i, len), ++n;
+    }
+    return n;
+}
+
+}